@@ -0,0 +1,222 @@
+/*
+ * Driver-specific API of the out-of-tree STM32U5 DCMI driver (GPDMA).
+ * Everything here is in addition to the generic video API.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_VIDEO_STM32U5_DCMI_H_
+#define ZEPHYR_INCLUDE_DRIVERS_VIDEO_STM32U5_DCMI_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/video.h>
+#include <zephyr/drivers/video-controls.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Private controls, set with video_set_ctrl() on the DCMI device while the
+ * stream is stopped. They change the output format: read it back with
+ * video_get_format() before allocating buffers.
+ */
+/** Horizontal decimation: 1 = every pixel, 2 = every other pixel. */
+#define VIDEO_CID_STM32U5_DCMI_HDECIMATION	(VIDEO_CID_PRIVATE_BASE + 0x5500)
+/** Vertical decimation: 1 = every line, 2 = every other line. */
+#define VIDEO_CID_STM32U5_DCMI_VDECIMATION	(VIDEO_CID_PRIVATE_BASE + 0x5501)
+/** 1 = keep only the Y bytes of a YUYV/UYVY sensor stream (output GREY). */
+#define VIDEO_CID_STM32U5_DCMI_LUMA_ONLY	(VIDEO_CID_PRIVATE_BASE + 0x5502)
+
+/** Interrupt sources instrumented by CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS. */
+enum video_stm32u5_dcmi_irq {
+	/** DCMI interrupt (frame end, VSYNC, errors). */
+	VIDEO_STM32U5_DCMI_IRQ_DCMI,
+	/** GPDMA channel callback (transfer complete, errors). */
+	VIDEO_STM32U5_DCMI_IRQ_DMA,
+};
+
+/** Time spent in one interrupt source, in k_cycle_get_32() cycles. */
+struct video_stm32u5_dcmi_isr_stats {
+	uint32_t count;
+	uint32_t last_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+};
+
+/**
+ * Read (and optionally clear) the ISR cycle statistics of one interrupt source.
+ *
+ * @param dev   DCMI device
+ * @param irq   Interrupt source
+ * @param stats Filled with a snapshot of the counters
+ * @param reset Clear the counters after reading
+ * @retval 0 on success, -ENOTSUP when CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS=n
+ */
+int video_stm32u5_dcmi_get_isr_stats(const struct device *dev, enum video_stm32u5_dcmi_irq irq,
+				     struct video_stm32u5_dcmi_isr_stats *stats, bool reset);
+
+/**
+ * Called from interrupt context each time a band of
+ * CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES lines has landed in the buffer being
+ * captured. vbuf->line_offset is the first line of that band and
+ * vbuf->bytesused the number of valid bytes from the start of the buffer.
+ * The buffer still belongs to the driver: read the band, do not keep it.
+ */
+typedef void (*video_stm32u5_dcmi_band_cb_t)(const struct device *dev,
+					     struct video_buffer *vbuf, void *user_data);
+
+/**
+ * Register (or clear with NULL) the band-complete callback.
+ *
+ * @retval 0 on success, -ENOTSUP when CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES=0
+ */
+int video_stm32u5_dcmi_set_band_callback(const struct device *dev,
+					 video_stm32u5_dcmi_band_cb_t cb, void *user_data);
+
+/**
+ * GPDMA transfer profile of the DCMI channel. The defaults come from the
+ * dma-* properties of the st,stm32u5-dcmi devicetree node.
+ */
+struct video_stm32u5_dcmi_dma_profile {
+	/** Beats (32-bit words) per burst read from DCMI_DR */
+	uint8_t src_burst;
+	/** Beats (32-bit words) per burst written to memory */
+	uint8_t dest_burst;
+	/** GPDMA AHB master port (0 or 1) used to read DCMI_DR */
+	uint8_t src_port;
+	/** GPDMA AHB master port (0 or 1) used to write the frame buffer */
+	uint8_t dest_port;
+};
+
+/**
+ * Change the GPDMA profile used by the next video_stream_start().
+ * A burst must fit in the channel FIFO: 2 words on GPDMA channels 0..11,
+ * 8 words on channels 12..15.
+ *
+ * @retval 0 on success, -EBUSY while streaming, -EINVAL for an invalid profile
+ */
+int video_stm32u5_dcmi_set_dma_profile(const struct device *dev,
+				       const struct video_stm32u5_dcmi_dma_profile *profile);
+
+/** Read the GPDMA profile currently in use. */
+int video_stm32u5_dcmi_get_dma_profile(const struct device *dev,
+				       struct video_stm32u5_dcmi_dma_profile *profile);
+
+/**
+ * Hand every buffer still queued for capture back through video_dequeue(),
+ * untouched (bytesused is stale), e.g. to release or resize the buffer
+ * ring after a format change. The stream must be stopped.
+ *
+ * @retval 0 on success, -EBUSY while streaming
+ */
+int video_stm32u5_dcmi_flush(const struct device *dev);
+
+/** Capture counters, from driver init or the last reset. */
+struct video_stm32u5_dcmi_stats {
+	/** Frames handed out through video_dequeue() */
+	uint32_t frames;
+	/** Frames dropped because no buffer was enqueued at frame end */
+	uint32_t dropped;
+	/** JPEG frames dropped because they did not fit in the buffer */
+	uint32_t truncated;
+	/** DCMI FIFO overruns (the DMA did not drain DCMI_DR in time) */
+	uint32_t overruns;
+	/** Embedded-synchronization errors reported by the DCMI */
+	uint32_t sync_errors;
+	/** GPDMA transfer errors */
+	uint32_t dma_errors;
+	/** Captures restarted by the driver after one of the errors above */
+	uint32_t recoveries;
+};
+
+/**
+ * Read (and optionally clear) the capture counters.
+ *
+ * @param dev   DCMI device
+ * @param stats Filled with a snapshot of the counters
+ * @param reset Clear the counters after reading
+ * @retval 0 on success
+ */
+int video_stm32u5_dcmi_get_stats(const struct device *dev,
+				 struct video_stm32u5_dcmi_stats *stats, bool reset);
+
+/** Per-frame metadata of a buffer returned by video_dequeue(). */
+struct video_stm32u5_dcmi_frame_meta {
+	/** Frame number; counts every frame the DCMI completed, delivered or not */
+	uint32_t sequence;
+	/**
+	 * k_cycle_get_32() latched at the VSYNC edge that starts the vertical
+	 * blanking before the frame, so times measured from it include the
+	 * blanking. Cycle-accurate with the SysTick system timer only; with an
+	 * LPTIM system timer it counts LPTIM ticks (about 30 us).
+	 */
+	uint32_t vsync_cycles;
+	/** Frames dropped between the previous delivered frame and this one */
+	uint32_t dropped;
+};
+
+/**
+ * Read the metadata of the last frame delivered in vbuf. Valid until the
+ * buffer is enqueued again and refilled. vbuf->timestamp is the same VSYNC
+ * instant (start of the blanking before the frame) in milliseconds of uptime.
+ *
+ * @retval 0 on success, -ENOENT if vbuf never left the driver
+ */
+int video_stm32u5_dcmi_get_frame_meta(const struct device *dev, const struct video_buffer *vbuf,
+				      struct video_stm32u5_dcmi_frame_meta *meta);
+
+/** Outcome of one characterization run (one frame interval, one DMA profile). */
+struct video_stm32u5_dcmi_char_result {
+	struct video_stm32u5_dcmi_dma_profile profile;
+	/** Frame interval the sensor accepted (sets its pixel clock) */
+	struct video_frmival frmival;
+	/** Frames received during the run */
+	uint32_t frames;
+	/** Time between the first and the last frame received */
+	uint32_t elapsed_ms;
+	/** Bytes delivered per second over elapsed_ms */
+	uint32_t bytes_per_sec;
+	/** DCMI overruns during the run */
+	uint32_t overruns;
+	/**
+	 * Frames the sensor sent (from the frame interval and elapsed_ms) that
+	 * never completed: an estimate of frames lost to bus stalls.
+	 */
+	uint32_t stalled_frames;
+};
+
+typedef void (*video_stm32u5_dcmi_char_cb_t)(const struct device *dev,
+					     const struct video_stm32u5_dcmi_char_result *res,
+					     void *user_data);
+
+/**
+ * Measure the achievable DCMI throughput. For every frame interval the
+ * sensor offers at the current format, and for every profile, stream
+ * num_frames frames and report one result. The stream must be stopped
+ * and the caller's buffers enqueued; both are left that way on return,
+ * with the previous frame interval and DMA profile restored.
+ *
+ * Only available with CONFIG_VIDEO_STM32U5_DCMI_CHARACTERIZE.
+ *
+ * @param dev          DCMI device
+ * @param profiles     DMA profiles to try
+ * @param num_profiles Number of entries in profiles
+ * @param num_frames   Frames captured per run
+ * @param cb           Called with each result (may be NULL, results are logged)
+ * @param user_data    Passed to cb
+ * @retval 0 on success or a negative error code
+ */
+int video_stm32u5_dcmi_characterize(const struct device *dev,
+				    const struct video_stm32u5_dcmi_dma_profile *profiles,
+				    size_t num_profiles, uint32_t num_frames,
+				    video_stm32u5_dcmi_char_cb_t cb, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_VIDEO_STM32U5_DCMI_H_ */
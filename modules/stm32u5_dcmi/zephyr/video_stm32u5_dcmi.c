@@ -21,9 +21,11 @@
 #include <zephyr/drivers/clock_control.h>
 #include <zephyr/drivers/dma.h>
 #include <zephyr/drivers/dma/dma_stm32.h>
+#include <zephyr/drivers/video/stm32u5_dcmi.h>
 
 #include <stm32_ll_dma.h>
 
+#include "video_ctrls.h"
 #include "video_device.h"
 
 LOG_MODULE_REGISTER(video_stm32u5_dcmi, CONFIG_VIDEO_LOG_LEVEL);
@@ -32,6 +34,40 @@ LOG_MODULE_REGISTER(video_stm32u5_dcmi, CONFIG_VIDEO_LOG_LEVEL);
 #error "The minimum required number of buffers for video_stm32 is 2"
 #endif
 
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_CONTINUOUS)
+#define STM32_DCMI_CAPTURE_MODE		DCMI_MODE_CONTINUOUS
+#else
+#define STM32_DCMI_CAPTURE_MODE		DCMI_MODE_SNAPSHOT
+#endif
+
+/*
+ * One GPDMA block is limited to 65 535 bytes (16-bit BNDT). Larger frames
+ * are split over a linked-list queue of nodes, each node a whole number of
+ * lines, so the DMA walks the full frame without CPU work between blocks.
+ */
+#define STM32_DCMI_DMA_MAX_BLOCK	0xFFFCU
+#define STM32_DCMI_DMA_MAX_NODES	CONFIG_VIDEO_STM32U5_DCMI_DMA_MAX_NODES
+
+/*
+ * With band delivery every node is one band of lines and completes with its
+ * own transfer-complete event; otherwise only the last node raises one.
+ */
+#define STM32_DCMI_BAND_LINES		CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES
+#define STM32_DCMI_DMA_TCEM							\
+	(STM32_DCMI_BAND_LINES > 0 ? DMA_TCEM_EACH_LL_ITEM_TRANSFER :		\
+				     DMA_TCEM_LAST_LL_ITEM_TRANSFER)
+
+#ifndef NODE_CDAR_DEFAULT_OFFSET
+#define NODE_CDAR_DEFAULT_OFFSET	4U
+#endif
+
+/*
+ * GPDMA fetches nodes relative to CLBAR, so the whole queue must sit in one
+ * 64 KB page: align the array to a power of two larger than its size.
+ */
+static DMA_NodeTypeDef stm32_dcmi_dma_nodes[STM32_DCMI_DMA_MAX_NODES] __aligned(2048);
+BUILD_ASSERT(sizeof(stm32_dcmi_dma_nodes) <= 2048, "DCMI DMA nodes must fit in 2 KB");
+
 typedef void (*irq_config_func_t)(const struct device *dev);
 
 struct stream {
@@ -41,14 +77,59 @@ struct stream {
 	struct dma_config cfg;
 };
 
+struct video_stm32_dcmi_ctrls {
+	struct video_ctrl hdecimation;
+	struct video_ctrl vdecimation;
+	struct video_ctrl luma_only;
+};
+
+/* Metadata of a delivered buffer, keyed by the buffer (driver_data is the fifo link) */
+struct stm32_dcmi_meta_slot {
+	const struct video_buffer *vbuf;
+	struct video_stm32u5_dcmi_frame_meta meta;
+};
+
+/* VSYNC latch of the frame being captured, and of the next one if it started first */
+struct stm32_dcmi_vsync {
+	uint32_t cycles;
+	uint32_t ms;
+};
+
 struct video_stm32_dcmi_data {
 	const struct device *dev;
+	struct video_stm32_dcmi_ctrls ctrls;
 	DCMI_HandleTypeDef hdcmi;
 	struct video_format fmt;
+	struct video_format sensor_fmt;
+	struct video_rect crop;
 	int capture_rate;
 	struct k_fifo fifo_in;
 	struct k_fifo fifo_out;
 	struct video_buffer *vbuf;
+	struct video_stm32u5_dcmi_dma_profile dma_profile;
+	DMA_NodeConfTypeDef dma_node_conf;
+	DMA_QListTypeDef dma_queue;
+	uint32_t dma_queue_bytes;
+	uint8_t dma_num_nodes;
+	uint32_t dma_node_bytes;
+	uint8_t band_idx;
+	bool jpeg_overflow;
+	video_stm32u5_dcmi_band_cb_t band_cb;
+	void *band_user_data;
+	struct video_stm32u5_dcmi_stats stats;
+	struct k_work recover_work;
+#if defined(CONFIG_POLL)
+	struct k_poll_signal *sig;
+#endif
+	uint32_t sequence;
+	uint32_t dropped_since;
+	struct stm32_dcmi_vsync vsync;
+	struct stm32_dcmi_vsync vsync_next;
+	bool vsync_next_valid;
+	struct stm32_dcmi_meta_slot meta[CONFIG_VIDEO_BUFFER_POOL_NUM_MAX];
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS)
+	struct video_stm32u5_dcmi_isr_stats isr_stats[VIDEO_STM32U5_DCMI_IRQ_DMA + 1];
+#endif
 };
 
 struct video_stm32_dcmi_config {
@@ -57,61 +138,571 @@ struct video_stm32_dcmi_config {
 	const struct pinctrl_dev_config *pctrl;
 	const struct device *sensor_dev;
 	const struct stream dma;
+	const struct video_stm32u5_dcmi_dma_profile dma_profile;
 };
 
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS)
+#define STM32_DCMI_ISR_ENTER(start) uint32_t start = k_cycle_get_32()
+
+static void stm32_dcmi_isr_exit(struct video_stm32_dcmi_data *data,
+				enum video_stm32u5_dcmi_irq irq, uint32_t start)
+{
+	struct video_stm32u5_dcmi_isr_stats *stats = &data->isr_stats[irq];
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	stats->count++;
+	stats->last_cycles = cycles;
+	stats->total_cycles += cycles;
+	if (cycles > stats->max_cycles) {
+		stats->max_cycles = cycles;
+	}
+}
+#define STM32_DCMI_ISR_EXIT(data, irq, start) stm32_dcmi_isr_exit(data, irq, start)
+#else
+#define STM32_DCMI_ISR_ENTER(start)
+#define STM32_DCMI_ISR_EXIT(data, irq, start)
+#endif
+
+/* Notify the consumer registered with video_set_signal(), if any */
+static inline void stm32_dcmi_raise_signal(struct video_stm32_dcmi_data *data, int result)
+{
+#if defined(CONFIG_POLL)
+	if (data->sig != NULL) {
+		k_poll_signal_raise(data->sig, result);
+	}
+#endif
+}
+
+/* Stop taking DCMI events and let stm32_dcmi_recover() restart the capture */
+static void stm32_dcmi_schedule_recovery(struct video_stm32_dcmi_data *data)
+{
+	__HAL_DCMI_DISABLE_IT(&data->hdcmi, DCMI_IT_FRAME | DCMI_IT_OVR | DCMI_IT_ERR |
+					    DCMI_IT_VSYNC | DCMI_IT_LINE);
+	k_work_submit(&data->recover_work);
+	stm32_dcmi_raise_signal(data, VIDEO_BUF_ERROR);
+}
+
 void HAL_DCMI_ErrorCallback(DCMI_HandleTypeDef *hdcmi)
 {
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdcmi, struct video_stm32_dcmi_data, hdcmi);
+
+	/*
+	 * An overrun also aborts the DMA, which adds HAL_DCMI_ERROR_DMA: DMA
+	 * errors are counted from the GPDMA error callback instead.
+	 */
+	if ((hdcmi->ErrorCode & HAL_DCMI_ERROR_OVR) != 0U) {
+		data->stats.overruns++;
+	}
+	if ((hdcmi->ErrorCode & HAL_DCMI_ERROR_SYNC) != 0U) {
+		data->stats.sync_errors++;
+	}
+	/* ErrorCode accumulates: clear it so every error is counted once */
+	hdcmi->ErrorCode = HAL_DCMI_ERROR_NONE;
+
 	LOG_WRN("%s", __func__);
+	stm32_dcmi_schedule_recovery(data);
+}
+
+/*
+ * (Re)build the linked-list queue for frames of frame_bytes. Nodes carry whole
+ * lines (pitch) so a node boundary never splits a line; the last node takes
+ * the remainder. Destination addresses are patched per buffer at arm time.
+ */
+static int stm32_dcmi_build_dma_queue(struct video_stm32_dcmi_data *data, uint32_t frame_bytes)
+{
+	DMA_HandleTypeDef *hdma = data->hdcmi.DMA_Handle;
+	DMA_NodeConfTypeDef *conf = &data->dma_node_conf;
+	uint32_t pitch = data->fmt.pitch;
+	uint32_t node_bytes;
+	uint32_t num_nodes;
+
+	if (frame_bytes == data->dma_queue_bytes) {
+		return 0;
+	}
+
+	if (STM32_DCMI_BAND_LINES > 0 && pitch != 0U && (pitch % 4U) == 0U &&
+	    STM32_DCMI_BAND_LINES * pitch <= STM32_DCMI_DMA_MAX_BLOCK) {
+		node_bytes = STM32_DCMI_BAND_LINES * pitch;
+	} else if (pitch != 0U && pitch <= STM32_DCMI_DMA_MAX_BLOCK && (pitch % 4U) == 0U) {
+		if (STM32_DCMI_BAND_LINES > 0) {
+			LOG_WRN("%u-line bands of %u bytes exceed one DMA block",
+				STM32_DCMI_BAND_LINES, pitch);
+		}
+		node_bytes = (STM32_DCMI_DMA_MAX_BLOCK / pitch) * pitch;
+	} else {
+		node_bytes = STM32_DCMI_DMA_MAX_BLOCK;
+	}
+
+	num_nodes = DIV_ROUND_UP(frame_bytes, node_bytes);
+	if (frame_bytes == 0U || num_nodes > STM32_DCMI_DMA_MAX_NODES) {
+		LOG_ERR("Frame of %u bytes needs %u DMA nodes (max %u)", frame_bytes,
+			num_nodes, STM32_DCMI_DMA_MAX_NODES);
+		return -EINVAL;
+	}
+
+	if (hdma->LinkedListQueue != NULL) {
+		HAL_DMAEx_List_UnLinkQ(hdma);
+	}
+	HAL_DMAEx_List_ResetQ(&data->dma_queue);
+
+	for (uint32_t i = 0; i < num_nodes; i++) {
+		conf->SrcAddress = (uint32_t)&data->hdcmi.Instance->DR;
+		conf->DstAddress = 0;
+		conf->DataSize = MIN(node_bytes, frame_bytes - i * node_bytes);
+
+		if (HAL_DMAEx_List_BuildNode(conf, &stm32_dcmi_dma_nodes[i]) != HAL_OK ||
+		    HAL_DMAEx_List_InsertNode_Tail(&data->dma_queue,
+						   &stm32_dcmi_dma_nodes[i]) != HAL_OK) {
+			LOG_ERR("Failed to build DMA node %u", i);
+			return -EIO;
+		}
+	}
+
+	if (HAL_DMAEx_List_LinkQ(hdma, &data->dma_queue) != HAL_OK) {
+		LOG_ERR("Failed to link DMA queue");
+		return -EIO;
+	}
+
+	data->dma_num_nodes = num_nodes;
+	data->dma_node_bytes = node_bytes;
+	data->dma_queue_bytes = frame_bytes;
+
+	LOG_DBG("DMA queue: %u bytes in %u node(s) of %u", frame_bytes, num_nodes, node_bytes);
+
+	return 0;
+}
+
+static inline bool stm32_dcmi_is_jpeg(const struct video_stm32_dcmi_data *data)
+{
+	return data->fmt.pixelformat == VIDEO_PIX_FMT_JPEG;
+}
+
+/* Bytes the DMA may write into vbuf for one frame */
+static uint32_t stm32_dcmi_frame_bytes(const struct video_stm32_dcmi_data *data,
+				       const struct video_buffer *vbuf)
+{
+	/* JPEG: the whole buffer (in DMA words) is available to the frame */
+	if (stm32_dcmi_is_jpeg(data)) {
+		return ROUND_DOWN(vbuf->size, sizeof(uint32_t));
+	}
+
+	return data->fmt.pitch * data->fmt.height;
+}
+
+/* Program the GPDMA channel to fill the current target buffer with one frame */
+static int stm32_dcmi_arm_dma(struct video_stm32_dcmi_data *data)
+{
+	uint32_t dst = (uint32_t)data->vbuf->buffer;
+
+	/* JPEG buffers may differ in size: the queue follows the buffer capacity */
+	if (stm32_dcmi_build_dma_queue(data, data->vbuf->bytesused) != 0) {
+		return -EINVAL;
+	}
+
+	for (uint8_t i = 0; i < data->dma_num_nodes; i++) {
+		stm32_dcmi_dma_nodes[i].LinkRegisters[NODE_CDAR_DEFAULT_OFFSET] =
+			dst + i * data->dma_node_bytes;
+	}
+
+	data->band_idx = 0;
+	data->jpeg_overflow = false;
+
+	if (HAL_DMAEx_List_Start_IT(data->hdcmi.DMA_Handle) != HAL_OK) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * VSYNC_RIS is set on the VSYNC inactive-to-active edge (VSPOL is the level
+ * while data is not valid): the start of the vertical blanking right after
+ * a frame, not the start of the next one. The stamp belongs to the frame
+ * after that blanking. In continuous mode the frame-end IT waits for the
+ * DMA, so this edge may come before the previous frame is handed out
+ * (FRAME_RIS still pending): keep it apart until then.
+ */
+void HAL_DCMI_VsyncEventCallback(DCMI_HandleTypeDef *hdcmi)
+{
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdcmi, struct video_stm32_dcmi_data, hdcmi);
+	struct stm32_dcmi_vsync vsync = {
+		.cycles = k_cycle_get_32(),
+		.ms = k_uptime_get_32(),
+	};
+
+	if ((hdcmi->Instance->RISR & DCMI_RIS_FRAME_RIS) != 0U) {
+		data->vsync_next = vsync;
+		data->vsync_next_valid = true;
+	} else {
+		data->vsync = vsync;
+	}
+}
+
+/* Record the metadata of a buffer about to leave the driver */
+static void stm32_dcmi_set_meta(struct video_stm32_dcmi_data *data,
+				const struct video_buffer *vbuf)
+{
+	struct stm32_dcmi_meta_slot *slot = NULL;
+
+	for (size_t i = 0; i < ARRAY_SIZE(data->meta); i++) {
+		if (data->meta[i].vbuf == vbuf) {
+			slot = &data->meta[i];
+			break;
+		}
+		if (slot == NULL && data->meta[i].vbuf == NULL) {
+			slot = &data->meta[i];
+		}
+	}
+
+	if (slot == NULL) {
+		return;
+	}
+
+	slot->vbuf = vbuf;
+	slot->meta.sequence = data->sequence;
+	slot->meta.vsync_cycles = data->vsync.cycles;
+	slot->meta.dropped = data->dropped_since;
+	data->dropped_since = 0;
 }
 
 void HAL_DCMI_FrameEventCallback(DCMI_HandleTypeDef *hdcmi)
 {
 	struct video_stm32_dcmi_data *dev_data =
 			CONTAINER_OF(hdcmi, struct video_stm32_dcmi_data, hdcmi);
-	struct video_buffer *vbuf;
+	struct video_buffer *vbuf = NULL;
+	bool jpeg = stm32_dcmi_is_jpeg(dev_data);
+	bool dma_stopping = false;
+	uint32_t jpeg_bytes = 0;
 
 	/*
 	 * With GPDMA (DMA_NORMAL) + DCMI_MODE_SNAPSHOT both the DMA and the
 	 * DCMI have already stopped by the time this callback fires, so
 	 * Suspend/Resume are unnecessary and would restart an unwanted capture.
+	 * In DCMI_MODE_CONTINUOUS the DCMI keeps running and the DMA is re-armed
+	 * below, before the first line of the next frame arrives.
+	 *
+	 * A JPEG frame ends before the buffer does, so the DMA is still running:
+	 * its destination pointer gives the compressed length, then it is
+	 * suspended and reset from the DMA interrupt (no wait in this ISR), and
+	 * dcmi_dma_xfer_abort() re-arms it. A channel that already ran to the
+	 * end of the buffer is idle and re-armed here.
+	 */
+	if (jpeg) {
+		jpeg_bytes = hdcmi->DMA_Handle->Instance->CDAR - (uint32_t)dev_data->vbuf->buffer;
+		dma_stopping = HAL_DMA_Abort_IT(hdcmi->DMA_Handle) == HAL_OK;
+	}
+
+	/*
+	 * Zero-copy handoff: the buffer the DMA just filled goes to fifo_out and
+	 * the next queued buffer becomes the DMA target. Without a free buffer
+	 * the frame is dropped and the current buffer stays the DMA target.
 	 */
+	if (jpeg && dev_data->jpeg_overflow) {
+		LOG_DBG("JPEG frame larger than %u bytes, dropped", dev_data->vbuf->bytesused);
+		dev_data->stats.truncated++;
+	} else {
+		vbuf = k_fifo_get(&dev_data->fifo_in, K_NO_WAIT);
+		if (vbuf == NULL) {
+			LOG_DBG("Failed to get buffer from fifo");
+			dev_data->stats.dropped++;
+		}
+	}
+
+	if (vbuf != NULL) {
+		if (jpeg) {
+			dev_data->vbuf->bytesused = jpeg_bytes;
+		}
+		/* Time of the VSYNC that started this frame, not of its end */
+		dev_data->vbuf->timestamp = dev_data->vsync.ms;
+		stm32_dcmi_set_meta(dev_data, dev_data->vbuf);
+		k_fifo_put(&dev_data->fifo_out, dev_data->vbuf);
+		dev_data->stats.frames++;
+		stm32_dcmi_raise_signal(dev_data, VIDEO_BUF_DONE);
+
+		dev_data->vbuf = vbuf;
+	} else {
+		dev_data->dropped_since++;
+	}
+
+	/* Every completed frame takes a sequence number, delivered or not */
+	dev_data->sequence++;
+	if (dev_data->vsync_next_valid) {
+		dev_data->vsync = dev_data->vsync_next;
+		dev_data->vsync_next_valid = false;
+	}
+
+	if (STM32_DCMI_CAPTURE_MODE == DCMI_MODE_CONTINUOUS) {
+		/* Frame IT is re-enabled by the transfer complete of the next frame */
+		if (!jpeg) {
+			__HAL_DCMI_DISABLE_IT(hdcmi, DCMI_IT_FRAME);
+		}
+
+		if (!dma_stopping && stm32_dcmi_arm_dma(dev_data) != 0) {
+			LOG_DBG("Failed to re-arm DCMI DMA");
+		}
+	}
+}
+
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_FAST_ISR)
+/*
+ * Register-level equivalent of HAL_DCMI_IRQHandler(): one MISR read, one ICR
+ * write, and the callbacks called directly. On errors the channel is only
+ * suspended (no wait for it here): stm32_dcmi_recover() resets it.
+ */
+static void stm32_dcmi_isr_fast(DCMI_HandleTypeDef *hdcmi)
+{
+	DCMI_TypeDef *regs = hdcmi->Instance;
+	uint32_t mis = regs->MISR;
 
-	vbuf = k_fifo_get(&dev_data->fifo_in, K_NO_WAIT);
+	regs->ICR = mis;
 
-	if (vbuf == NULL) {
-		LOG_DBG("Failed to get buffer from fifo");
+	if ((mis & (DCMI_MIS_OVR_MIS | DCMI_MIS_ERR_MIS)) != 0U) {
+		hdcmi->ErrorCode |= ((mis & DCMI_MIS_OVR_MIS) ? HAL_DCMI_ERROR_OVR : 0U) |
+				    ((mis & DCMI_MIS_ERR_MIS) ? HAL_DCMI_ERROR_SYNC : 0U);
+		hdcmi->State = HAL_DCMI_STATE_ERROR;
+		hdcmi->DMA_Handle->Instance->CCR |= DMA_CCR_SUSP;
+		HAL_DCMI_ErrorCallback(hdcmi);
 		return;
 	}
 
-	vbuf->timestamp = k_uptime_get_32();
-	memcpy(vbuf->buffer, dev_data->vbuf->buffer, vbuf->bytesused);
+	if ((mis & DCMI_MIS_VSYNC_MIS) != 0U) {
+		HAL_DCMI_VsyncEventCallback(hdcmi);
+	}
 
-	k_fifo_put(&dev_data->fifo_out, vbuf);
+	if ((mis & DCMI_MIS_FRAME_MIS) != 0U) {
+		if (STM32_DCMI_CAPTURE_MODE == DCMI_MODE_SNAPSHOT) {
+			regs->IER &= ~(DCMI_IT_LINE | DCMI_IT_VSYNC | DCMI_IT_ERR | DCMI_IT_OVR |
+				       DCMI_IT_FRAME);
+		}
+		HAL_DCMI_FrameEventCallback(hdcmi);
+	}
 }
+#endif
 
 static void stm32_dcmi_isr(const struct device *dev)
 {
 	struct video_stm32_dcmi_data *data = dev->data;
+	STM32_DCMI_ISR_ENTER(start);
 
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_FAST_ISR)
+	stm32_dcmi_isr_fast(&data->hdcmi);
+#else
 	HAL_DCMI_IRQHandler(&data->hdcmi);
+#endif
+
+	STM32_DCMI_ISR_EXIT(data, VIDEO_STM32U5_DCMI_IRQ_DCMI, start);
 }
 
 static void dcmi_dma_callback(const struct device *dev, void *arg, uint32_t channel, int status)
 {
 	DMA_HandleTypeDef *hdma = arg;
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdma->Parent, struct video_stm32_dcmi_data, hdcmi);
+	STM32_DCMI_ISR_ENTER(start);
 
 	ARG_UNUSED(dev);
+	ARG_UNUSED(data);
 
 	if (status < 0) {
 		LOG_ERR("DMA callback error with channel %d.", channel);
 	}
 
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_FAST_ISR)
+	/*
+	 * Transfer complete only (the common case): clear it and call the
+	 * handler directly. Errors and anything else go through the HAL.
+	 */
+	uint32_t csr = hdma->Instance->CSR;
+
+	if ((csr & (DMA_CSR_TCF | DMA_CSR_DTEF | DMA_CSR_ULEF | DMA_CSR_USEF | DMA_CSR_TOF)) ==
+	    DMA_CSR_TCF) {
+		hdma->Instance->CFCR = DMA_CFCR_TCF;
+		/* Last node done: the channel is idle, as the HAL would record it */
+		if (hdma->Instance->CLLR == 0U) {
+			hdma->State = HAL_DMA_STATE_READY;
+			__HAL_UNLOCK(hdma);
+		}
+		hdma->XferCpltCallback(hdma);
+	} else {
+		HAL_DMA_IRQHandler(hdma);
+	}
+#else
 	HAL_DMA_IRQHandler(hdma);
+#endif
+
+	STM32_DCMI_ISR_EXIT(data, VIDEO_STM32U5_DCMI_IRQ_DMA, start);
 }
 
 void HAL_DMA_ErrorCallback(DMA_HandleTypeDef *hdma)
 {
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdma->Parent, struct video_stm32_dcmi_data, hdcmi);
+
+	data->stats.dma_errors++;
+
 	LOG_WRN("%s", __func__);
+	stm32_dcmi_schedule_recovery(data);
+}
+
+/*
+ * The whole frame has been written to memory: only now let the DCMI frame
+ * interrupt through, so the buffer handoff never races the last DMA beats.
+ */
+static void dcmi_dma_xfer_cplt(DMA_HandleTypeDef *hdma)
+{
+	DCMI_HandleTypeDef *hdcmi = hdma->Parent;
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdcmi, struct video_stm32_dcmi_data, hdcmi);
+
+	if (stm32_dcmi_is_jpeg(data)) {
+		/*
+		 * Last node done (no next link) before the frame end: the buffer
+		 * is full and the frame truncated. Band mode raises this event
+		 * for every node, the earlier ones are not an overflow.
+		 */
+		if (hdma->Instance->CLLR == 0U) {
+			data->jpeg_overflow = true;
+		}
+		return;
+	}
+
+	if (STM32_DCMI_BAND_LINES > 0) {
+		/* One event per node: publish the band that just landed */
+		struct video_buffer *vbuf = data->vbuf;
+		uint8_t idx = data->band_idx++;
+		uint32_t lines_per_node = data->fmt.pitch ?
+					  data->dma_node_bytes / data->fmt.pitch : 0;
+
+		vbuf->line_offset = idx * lines_per_node;
+		vbuf->bytesused = MIN((idx + 1U) * data->dma_node_bytes, data->dma_queue_bytes);
+
+		if (data->band_cb != NULL) {
+			data->band_cb(data->dev, vbuf, data->band_user_data);
+		}
+
+		if (data->band_idx < data->dma_num_nodes) {
+			return;
+		}
+
+		/* Whole frame landed: the buffer leaves the driver as a full frame */
+		vbuf->line_offset = 0;
+	}
+
+	__HAL_DCMI_ENABLE_IT(hdcmi, DCMI_IT_FRAME);
+}
+
+/*
+ * JPEG frame end: the channel stopped by HAL_DMA_Abort_IT() is reset, so
+ * the next frame can be armed. Not after a stop or an error (DCMI not busy).
+ */
+static void dcmi_dma_xfer_abort(DMA_HandleTypeDef *hdma)
+{
+	DCMI_HandleTypeDef *hdcmi = hdma->Parent;
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(hdcmi, struct video_stm32_dcmi_data, hdcmi);
+
+	if (STM32_DCMI_CAPTURE_MODE != DCMI_MODE_CONTINUOUS ||
+	    hdcmi->State != HAL_DCMI_STATE_BUSY || data->vbuf == NULL) {
+		return;
+	}
+
+	if (stm32_dcmi_arm_dma(data) != 0) {
+		LOG_DBG("Failed to re-arm DCMI DMA");
+	}
+}
+
+static int stm32_dcmi_start_capture(struct video_stm32_dcmi_data *data)
+{
+	DCMI_HandleTypeDef *hdcmi = &data->hdcmi;
+	DMA_HandleTypeDef *hdma = hdcmi->DMA_Handle;
+
+	hdma->XferCpltCallback = dcmi_dma_xfer_cplt;
+	hdma->XferErrorCallback = HAL_DMA_ErrorCallback;
+	/* Also restores it after HAL_DCMI_IRQHandler() set its own for an error */
+	hdma->XferAbortCallback = dcmi_dma_xfer_abort;
+
+	MODIFY_REG(hdcmi->Instance->CR, DCMI_CR_CM, STM32_DCMI_CAPTURE_MODE);
+	__HAL_DCMI_ENABLE(hdcmi);
+
+	if (stm32_dcmi_arm_dma(data) != 0) {
+		__HAL_DCMI_DISABLE(hdcmi);
+		return -EIO;
+	}
+
+	hdcmi->State = HAL_DCMI_STATE_BUSY;
+	data->vsync_next_valid = false;
+	/* JPEG: the frame end, not the DMA, tells when a frame is complete */
+	__HAL_DCMI_ENABLE_IT(hdcmi, DCMI_IT_OVR | DCMI_IT_ERR | DCMI_IT_VSYNC |
+			     (stm32_dcmi_is_jpeg(data) ? DCMI_IT_FRAME : 0));
+	hdcmi->Instance->CR |= DCMI_CR_CAPTURE;
+
+	return 0;
+}
+
+/*
+ * Error recovery, in thread context: reset the DCMI and its GPDMA channel,
+ * give the buffer that was being filled back to fifo_in and restart the
+ * capture, which resumes at the next VSYNC. The sensor keeps streaming, so
+ * a glitch costs the frame it hit.
+ */
+static void stm32_dcmi_recover(struct k_work *work)
+{
+	struct video_stm32_dcmi_data *data =
+			CONTAINER_OF(work, struct video_stm32_dcmi_data, recover_work);
+	DCMI_HandleTypeDef *hdcmi = &data->hdcmi;
+	unsigned int key;
+
+	if (data->vbuf == NULL) {
+		/* Stream stopped in the meantime */
+		return;
+	}
+
+	/* Disabling the DCMI flushes its FIFO; Stop also aborts the channel */
+	(void)HAL_DCMI_Stop(hdcmi);
+	if (hdcmi->DMA_Handle->State != HAL_DMA_STATE_READY) {
+		(void)HAL_DMA_Abort(hdcmi->DMA_Handle);
+	}
+	hdcmi->ErrorCode = HAL_DCMI_ERROR_NONE;
+	hdcmi->State = HAL_DCMI_STATE_READY;
+
+	/* The lost frame shows up as a gap in the frame metadata */
+	key = irq_lock();
+	data->sequence++;
+	data->dropped_since++;
+	irq_unlock(key);
+
+	data->vbuf->bytesused = stm32_dcmi_frame_bytes(data, data->vbuf);
+	data->vbuf->line_offset = 0;
+	k_fifo_put(&data->fifo_in, data->vbuf);
+	data->vbuf = k_fifo_get(&data->fifo_in, K_NO_WAIT);
+
+	if (stm32_dcmi_start_capture(data) != 0) {
+		LOG_ERR("DCMI recovery failed");
+		k_fifo_put(&data->fifo_in, data->vbuf);
+		data->vbuf = NULL;
+		return;
+	}
+
+	data->stats.recoveries++;
+	LOG_DBG("DCMI capture restarted after error");
+}
+
+/* Burst lengths and AHB ports of the node template; nodes are rebuilt on next start */
+static void stm32_dcmi_set_dma_profile(struct video_stm32_dcmi_data *data,
+				       const struct video_stm32u5_dcmi_dma_profile *profile)
+{
+	DMA_NodeConfTypeDef *conf = &data->dma_node_conf;
+
+	conf->Init.SrcBurstLength = profile->src_burst;
+	conf->Init.DestBurstLength = profile->dest_burst;
+	conf->Init.TransferAllocatedPort =
+		(profile->src_port ? DMA_SRC_ALLOCATED_PORT1 : DMA_SRC_ALLOCATED_PORT0) |
+		(profile->dest_port ? DMA_DEST_ALLOCATED_PORT1 : DMA_DEST_ALLOCATED_PORT0);
+
+	data->dma_profile = *profile;
+	data->dma_queue_bytes = 0;
 }
 
 static int stm32_dma_init(const struct device *dev)
@@ -138,26 +729,37 @@ static int stm32_dma_init(const struct device *dev)
 		return ret;
 	}
 
-	/* GPDMA (STM32U5) configuration */
-	hdma.Init.Request		= dma_cfg.dma_slot;
-	hdma.Init.Direction		= DMA_PERIPH_TO_MEMORY;
-	hdma.Init.SrcInc		= DMA_SINC_FIXED;
-	hdma.Init.DestInc		= DMA_DINC_INCREMENTED;
-	hdma.Init.SrcDataWidth		= DMA_SRC_DATAWIDTH_WORD;
-	hdma.Init.DestDataWidth		= DMA_DEST_DATAWIDTH_WORD;
-	hdma.Init.SrcBurstLength	= 1;
-	hdma.Init.DestBurstLength	= 1;
-	hdma.Init.Priority		= DMA_HIGH_PRIORITY;
-	hdma.Init.Mode			= DMA_NORMAL;
-	hdma.Init.BlkHWRequest		= DMA_BREQ_SINGLE_BURST;
-	hdma.Init.TransferAllocatedPort	= DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
-	hdma.Init.TransferEventMode	= DMA_TCEM_BLOCK_TRANSFER;
+	/* GPDMA (STM32U5) linked-list channel configuration */
+	hdma.InitLinkedList.Priority		= DMA_HIGH_PRIORITY;
+	hdma.InitLinkedList.LinkStepMode	= DMA_LSM_FULL_EXECUTION;
+	hdma.InitLinkedList.LinkAllocatedPort	= DMA_LINK_ALLOCATED_PORT0;
+	hdma.InitLinkedList.TransferEventMode	= STM32_DCMI_DMA_TCEM;
+	hdma.InitLinkedList.LinkedListMode	= DMA_LINKEDLIST_NORMAL;
 	hdma.Instance = LL_DMA_GET_CHANNEL_INSTANCE(config->dma.reg,
 						config->dma.channel);
 
+	/* Template for every node of the frame queue */
+	DMA_NodeConfTypeDef *conf = &data->dma_node_conf;
+
+	conf->NodeType				= DMA_GPDMA_LINEAR_NODE;
+	conf->Init.Request			= dma_cfg.dma_slot;
+	conf->Init.BlkHWRequest			= DMA_BREQ_SINGLE_BURST;
+	conf->Init.Direction			= DMA_PERIPH_TO_MEMORY;
+	conf->Init.SrcInc			= DMA_SINC_FIXED;
+	conf->Init.DestInc			= DMA_DINC_INCREMENTED;
+	conf->Init.SrcDataWidth			= DMA_SRC_DATAWIDTH_WORD;
+	conf->Init.DestDataWidth		= DMA_DEST_DATAWIDTH_WORD;
+	conf->Init.Priority			= DMA_HIGH_PRIORITY;
+	conf->Init.Mode				= DMA_NORMAL;
+	conf->Init.TransferEventMode		= STM32_DCMI_DMA_TCEM;
+	conf->DataHandlingConfig.DataExchange	= DMA_EXCHANGE_NONE;
+	conf->DataHandlingConfig.DataAlignment	= DMA_DATA_RIGHTALIGN_ZEROPADDED;
+	conf->TriggerConfig.TriggerPolarity	= DMA_TRIG_POLARITY_MASKED;
+	stm32_dcmi_set_dma_profile(data, &config->dma_profile);
+
 	__HAL_LINKDMA(&data->hdcmi, DMA_Handle, hdma);
 
-	if (HAL_DMA_Init(&hdma) != HAL_OK) {
+	if (HAL_DMAEx_List_Init(&hdma) != HAL_OK) {
 		LOG_ERR("DCMI DMA Init failed");
 		return -EIO;
 	}
@@ -178,20 +780,63 @@ static int stm32_dcmi_enable_clock(const struct device *dev)
 	return clock_control_on(dcmi_clock, (clock_control_subsys_t *)&config->pclken);
 }
 
+/*
+ * Derive the format that lands in memory from the sensor format and the
+ * DCMI crop window, and cache both.
+ */
+static void video_stm32_dcmi_update_fmt(struct video_stm32_dcmi_data *data,
+					struct video_format *fmt)
+{
+	data->sensor_fmt = *fmt;
+
+	if (data->crop.width == 0 || data->crop.height == 0 ||
+	    data->crop.left + data->crop.width > fmt->width ||
+	    data->crop.top + data->crop.height > fmt->height) {
+		data->crop = (struct video_rect){ .width = fmt->width, .height = fmt->height };
+	}
+
+	/* Byte/line select keep the first of every 2 pixels/lines of the window */
+	fmt->width = DIV_ROUND_UP(data->crop.width, data->ctrls.hdecimation.val);
+	fmt->height = DIV_ROUND_UP(data->crop.height, data->ctrls.vdecimation.val);
+	if (data->ctrls.luma_only.val &&
+	    (fmt->pixelformat == VIDEO_PIX_FMT_YUYV || fmt->pixelformat == VIDEO_PIX_FMT_UYVY)) {
+		fmt->pixelformat = VIDEO_PIX_FMT_GREY;
+	}
+	/* JPEG has no pitch: frames are as long as the encoder makes them */
+	fmt->pitch = fmt->width * video_bits_per_pixel(fmt->pixelformat) / BITS_PER_BYTE;
+
+	data->hdcmi.Init.JPEGMode = fmt->pixelformat == VIDEO_PIX_FMT_JPEG ?
+				    DCMI_JPEG_ENABLE : DCMI_JPEG_DISABLE;
+	MODIFY_REG(data->hdcmi.Instance->CR, DCMI_CR_JPEG, data->hdcmi.Init.JPEGMode);
+
+	data->fmt = *fmt;
+	/* Node split depends on the pitch: rebuild the DMA queue on next start */
+	data->dma_queue_bytes = 0;
+}
+
 static int video_stm32_dcmi_set_fmt(const struct device *dev, struct video_format *fmt)
 {
 	const struct video_stm32_dcmi_config *config = dev->config;
 	struct video_stm32_dcmi_data *data = dev->data;
 	int ret;
 
+	/* Byte/line select would corrupt a compressed stream */
+	if (fmt->pixelformat == VIDEO_PIX_FMT_JPEG &&
+	    (data->ctrls.hdecimation.val != 1 || data->ctrls.vdecimation.val != 1 ||
+	     data->ctrls.luma_only.val)) {
+		return -ENOTSUP;
+	}
+
 	ret = video_set_format(config->sensor_dev, fmt);
 	if (ret < 0) {
 		return ret;
 	}
 
-	fmt->pitch = fmt->width * video_bits_per_pixel(fmt->pixelformat) / BITS_PER_BYTE;
+	/* A new sensor format resets the crop window to the full frame */
+	data->crop = (struct video_rect){ .width = fmt->width, .height = fmt->height };
+	HAL_DCMI_DisableCrop(&data->hdcmi);
 
-	data->fmt = *fmt;
+	video_stm32_dcmi_update_fmt(data, fmt);
 
 	return 0;
 }
@@ -207,13 +852,109 @@ static int video_stm32_dcmi_get_fmt(const struct device *dev, struct video_forma
 		return ret;
 	}
 
-	fmt->pitch = fmt->width * video_bits_per_pixel(fmt->pixelformat) / BITS_PER_BYTE;
+	video_stm32_dcmi_update_fmt(data, fmt);
 
-	data->fmt = *fmt;
+	return 0;
+}
+
+/*
+ * Hardware crop: the DCMI only forwards the window to the DMA, so bus
+ * bandwidth and buffer size shrink with it. Widths are rounded down so a
+ * cropped line stays a whole number of 32-bit DMA words.
+ */
+/* Bytes a crop line of width pixels leaves after byte select */
+static uint32_t stm32_dcmi_line_bytes(const struct video_stm32_dcmi_data *data, uint32_t width)
+{
+	uint32_t bytes_pp = data->ctrls.luma_only.val ? 1U :
+			    video_bits_per_pixel(data->sensor_fmt.pixelformat) / BITS_PER_BYTE;
+
+	return DIV_ROUND_UP(width, data->ctrls.hdecimation.val) * bytes_pp;
+}
+
+/* Clamp/align rect to the sensor frame and program the DCMI crop window */
+static int stm32_dcmi_apply_crop(struct video_stm32_dcmi_data *data, struct video_rect *rect)
+{
+	const struct video_format *sfmt = &data->sensor_fmt;
+	struct video_format fmt = *sfmt;
+	/* 8-bit bus: one pixel clock per byte */
+	uint32_t bytes_pp = video_bits_per_pixel(sfmt->pixelformat) / BITS_PER_BYTE;
+
+	if (bytes_pp == 0 || sfmt->width == 0 || sfmt->height == 0) {
+		return -ENOTSUP;
+	}
+
+	rect->left = MIN(rect->left, sfmt->width - 1);
+	rect->top = MIN(rect->top, sfmt->height - 1);
+	rect->width = CLAMP(rect->width, 1, sfmt->width - rect->left);
+	rect->height = CLAMP(rect->height, 1, sfmt->height - rect->top);
+	while (rect->width > 0 && (stm32_dcmi_line_bytes(data, rect->width) % 4U) != 0U) {
+		rect->width--;
+	}
+	if (rect->width == 0) {
+		return -EINVAL;
+	}
+
+	if (rect->left == 0 && rect->top == 0 &&
+	    rect->width == sfmt->width && rect->height == sfmt->height) {
+		HAL_DCMI_DisableCrop(&data->hdcmi);
+	} else {
+		/* CWSIZE counts pixel clocks/lines minus one, CWSTRT starts at 0 */
+		if (HAL_DCMI_ConfigCrop(&data->hdcmi, rect->left * bytes_pp, rect->top,
+					rect->width * bytes_pp - 1, rect->height - 1) != HAL_OK ||
+		    HAL_DCMI_EnableCrop(&data->hdcmi) != HAL_OK) {
+			return -EIO;
+		}
+	}
+
+	data->crop = *rect;
+	video_stm32_dcmi_update_fmt(data, &fmt);
 
 	return 0;
 }
 
+static int video_stm32_dcmi_set_selection(const struct device *dev, struct video_selection *sel)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+
+	if (sel->target != VIDEO_SEL_TGT_CROP) {
+		return -EINVAL;
+	}
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	return stm32_dcmi_apply_crop(data, &sel->rect);
+}
+
+static int video_stm32_dcmi_get_selection(const struct device *dev, struct video_selection *sel)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+
+	switch (sel->target) {
+	case VIDEO_SEL_TGT_CROP:
+		sel->rect = data->crop;
+		return 0;
+	case VIDEO_SEL_TGT_CROP_BOUND:
+	case VIDEO_SEL_TGT_NATIVE_SIZE:
+		sel->rect = (struct video_rect){
+			.width = data->sensor_fmt.width,
+			.height = data->sensor_fmt.height,
+		};
+		return 0;
+	case VIDEO_SEL_TGT_COMPOSE:
+	case VIDEO_SEL_TGT_COMPOSE_BOUND:
+		/* Only 1:1 or decimated by byte/line select */
+		sel->rect = (struct video_rect){
+			.width = data->fmt.width,
+			.height = data->fmt.height,
+		};
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
 #define STM32_DCMI_GET_CAPTURE_RATE(capture_rate)					\
 	((capture_rate) == 1 ? DCMI_CR_ALL_FRAME :					\
 	(capture_rate) == 2 ? DCMI_CR_ALTERNATE_2_FRAME :				\
@@ -225,16 +966,24 @@ static int video_stm32_dcmi_set_stream(const struct device *dev, bool enable,
 {
 	struct video_stm32_dcmi_data *data = dev->data;
 	const struct video_stm32_dcmi_config *config = dev->config;
+	struct k_work_sync sync;
 	int err;
 
 	if (!enable) {
+		k_work_cancel_sync(&data->recover_work, &sync);
+
 		err = HAL_DCMI_Stop(&data->hdcmi);
 		if (err != HAL_OK) {
 			LOG_ERR("Failed to stop DCMI");
 			return -EIO;
 		}
 
-		k_fifo_put(&data->fifo_in, data->vbuf);
+		/* Give the buffer that was armed as DMA target back to the queue */
+		if (data->vbuf != NULL) {
+			k_fifo_put(&data->fifo_in, data->vbuf);
+			data->vbuf = NULL;
+			stm32_dcmi_raise_signal(data, VIDEO_BUF_ABORTED);
+		}
 
 		return 0;
 	}
@@ -249,11 +998,12 @@ static int video_stm32_dcmi_set_stream(const struct device *dev, bool enable,
 	data->hdcmi.Instance->CR &= ~(DCMI_CR_FCRC_0 | DCMI_CR_FCRC_1);
 	data->hdcmi.Instance->CR |= STM32_DCMI_GET_CAPTURE_RATE(data->capture_rate);
 
-	err = HAL_DCMI_Start_DMA(&data->hdcmi, DCMI_MODE_SNAPSHOT,
-			(uint32_t)data->vbuf->buffer, data->vbuf->bytesused / 4);
-	if (err != HAL_OK) {
+	err = stm32_dcmi_start_capture(data);
+	if (err < 0) {
 		LOG_ERR("Failed to start DCMI DMA");
-		return -EIO;
+		k_fifo_put(&data->fifo_in, data->vbuf);
+		data->vbuf = NULL;
+		return err;
 	}
 
 	return video_stream_start(config->sensor_dev, type);
@@ -262,7 +1012,7 @@ static int video_stm32_dcmi_set_stream(const struct device *dev, bool enable,
 static int video_stm32_dcmi_enqueue(const struct device *dev, struct video_buffer *vbuf)
 {
 	struct video_stm32_dcmi_data *data = dev->data;
-	const uint32_t buffer_size = data->fmt.pitch * data->fmt.height;
+	const uint32_t buffer_size = stm32_dcmi_frame_bytes(data, vbuf);
 
 	if (buffer_size > vbuf->size) {
 		return -EINVAL;
@@ -293,7 +1043,9 @@ static int video_stm32_dcmi_get_caps(const struct device *dev, struct video_caps
 {
 	const struct video_stm32_dcmi_config *config = dev->config;
 
-	caps->min_line_count = caps->max_line_count = LINE_COUNT_HEIGHT;
+	caps->min_line_count = STM32_DCMI_BAND_LINES > 0 ? STM32_DCMI_BAND_LINES :
+						       LINE_COUNT_HEIGHT;
+	caps->max_line_count = LINE_COUNT_HEIGHT;
 
 	return video_get_caps(config->sensor_dev, caps);
 }
@@ -380,6 +1132,220 @@ static int video_stm32_dcmi_get_frmival(const struct device *dev, struct video_f
 	return 0;
 }
 
+int video_stm32u5_dcmi_get_isr_stats(const struct device *dev, enum video_stm32u5_dcmi_irq irq,
+				     struct video_stm32u5_dcmi_isr_stats *stats, bool reset)
+{
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS)
+	struct video_stm32_dcmi_data *data = dev->data;
+	unsigned int key;
+
+	if (irq > VIDEO_STM32U5_DCMI_IRQ_DMA) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+	*stats = data->isr_stats[irq];
+	if (reset) {
+		data->isr_stats[irq] = (struct video_stm32u5_dcmi_isr_stats){0};
+	}
+	irq_unlock(key);
+
+	return 0;
+#else
+	ARG_UNUSED(dev);
+	ARG_UNUSED(irq);
+	ARG_UNUSED(stats);
+	ARG_UNUSED(reset);
+
+	return -ENOTSUP;
+#endif
+}
+
+int video_stm32u5_dcmi_set_band_callback(const struct device *dev,
+					 video_stm32u5_dcmi_band_cb_t cb, void *user_data)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+	unsigned int key;
+
+	if (STM32_DCMI_BAND_LINES == 0) {
+		return -ENOTSUP;
+	}
+
+	key = irq_lock();
+	data->band_cb = cb;
+	data->band_user_data = user_data;
+	irq_unlock(key);
+
+	return 0;
+}
+
+/* GPDMA channels 0..11 have an 8-byte FIFO, channels 12..15 a 32-byte one */
+#define STM32_DCMI_DMA_FIFO_WORDS(channel)	((channel) >= 12U ? 8U : 2U)
+
+int video_stm32u5_dcmi_set_dma_profile(const struct device *dev,
+				       const struct video_stm32u5_dcmi_dma_profile *profile)
+{
+	const struct video_stm32_dcmi_config *config = dev->config;
+	struct video_stm32_dcmi_data *data = dev->data;
+	uint32_t fifo_words = STM32_DCMI_DMA_FIFO_WORDS(config->dma.channel);
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	if (!IN_RANGE(profile->src_burst, 1, fifo_words) ||
+	    !IN_RANGE(profile->dest_burst, 1, fifo_words) ||
+	    profile->src_port > 1U || profile->dest_port > 1U) {
+		return -EINVAL;
+	}
+
+	stm32_dcmi_set_dma_profile(data, profile);
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_get_dma_profile(const struct device *dev,
+				       struct video_stm32u5_dcmi_dma_profile *profile)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+
+	*profile = data->dma_profile;
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_flush(const struct device *dev)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+	struct video_buffer *vbuf;
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	while ((vbuf = k_fifo_get(&data->fifo_in, K_NO_WAIT)) != NULL) {
+		k_fifo_put(&data->fifo_out, vbuf);
+	}
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_get_stats(const struct device *dev,
+				 struct video_stm32u5_dcmi_stats *stats, bool reset)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+	unsigned int key;
+
+	key = irq_lock();
+	*stats = data->stats;
+	if (reset) {
+		data->stats = (struct video_stm32u5_dcmi_stats){0};
+	}
+	irq_unlock(key);
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_get_frame_meta(const struct device *dev, const struct video_buffer *vbuf,
+				      struct video_stm32u5_dcmi_frame_meta *meta)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+	int ret = -ENOENT;
+	unsigned int key;
+
+	key = irq_lock();
+	for (size_t i = 0; i < ARRAY_SIZE(data->meta); i++) {
+		if (data->meta[i].vbuf == vbuf) {
+			*meta = data->meta[i].meta;
+			ret = 0;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	return ret;
+}
+
+/*
+ * Byte/line select: decimate by 2 horizontally/vertically and/or keep only
+ * the luma bytes of a YUV 4:2:2 stream. The DCMI drops the data before it
+ * reaches the DMA, so buffer size and bus traffic shrink accordingly.
+ */
+static int video_stm32_dcmi_set_ctrl(const struct device *dev, uint32_t id)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+	struct video_stm32_dcmi_ctrls *ctrls = &data->ctrls;
+	uint32_t pixfmt = data->sensor_fmt.pixelformat;
+	uint32_t bsm = DCMI_BSM_ALL;
+	uint32_t oebs = DCMI_OEBS_ODD;
+	struct video_rect crop = data->crop;
+
+	switch (id) {
+	case VIDEO_CID_STM32U5_DCMI_HDECIMATION:
+	case VIDEO_CID_STM32U5_DCMI_VDECIMATION:
+	case VIDEO_CID_STM32U5_DCMI_LUMA_ONLY:
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	if (pixfmt == VIDEO_PIX_FMT_JPEG) {
+		return -ENOTSUP;
+	}
+
+	if (ctrls->luma_only.val) {
+		/* YUYV carries Y on even bytes, UYVY on odd bytes */
+		if (pixfmt == VIDEO_PIX_FMT_YUYV) {
+			oebs = DCMI_OEBS_ODD;
+		} else if (pixfmt == VIDEO_PIX_FMT_UYVY) {
+			oebs = DCMI_OEBS_EVEN;
+		} else {
+			return -ENOTSUP;
+		}
+		bsm = ctrls->hdecimation.val == 2 ? DCMI_BSM_ALTERNATE_4 : DCMI_BSM_OTHER;
+	} else if (ctrls->hdecimation.val == 2) {
+		/* Keep one pixel out of two, whatever its size in bytes */
+		bsm = video_bits_per_pixel(pixfmt) == 8 ? DCMI_BSM_OTHER : DCMI_BSM_ALTERNATE_2;
+	}
+
+	MODIFY_REG(data->hdcmi.Instance->CR,
+		   DCMI_CR_BSM | DCMI_CR_OEBS | DCMI_CR_LSM | DCMI_CR_OELS,
+		   bsm | oebs |
+		   (ctrls->vdecimation.val == 2 ? DCMI_LSM_ALTERNATE_2 : DCMI_LSM_ALL) |
+		   DCMI_OELS_ODD);
+	data->hdcmi.Init.ByteSelectMode = bsm;
+	data->hdcmi.Init.ByteSelectStart = oebs;
+	data->hdcmi.Init.LineSelectMode =
+		ctrls->vdecimation.val == 2 ? DCMI_LSM_ALTERNATE_2 : DCMI_LSM_ALL;
+
+	if (data->sensor_fmt.width == 0) {
+		/* No format yet: applied by the next set_format */
+		return 0;
+	}
+
+	/* Output line size changed: re-align the crop window and the format */
+	return stm32_dcmi_apply_crop(data, &crop);
+}
+
+#if defined(CONFIG_POLL)
+static int video_stm32_dcmi_set_signal(const struct device *dev, struct k_poll_signal *sig)
+{
+	struct video_stm32_dcmi_data *data = dev->data;
+
+	if (data->sig != NULL && sig != NULL) {
+		return -EALREADY;
+	}
+
+	data->sig = sig;
+
+	return 0;
+}
+#endif
+
 static DEVICE_API(video, video_stm32_dcmi_driver_api) = {
 	.set_format = video_stm32_dcmi_set_fmt,
 	.get_format = video_stm32_dcmi_get_fmt,
@@ -390,6 +1356,12 @@ static DEVICE_API(video, video_stm32_dcmi_driver_api) = {
 	.enum_frmival = video_stm32_dcmi_enum_frmival,
 	.set_frmival = video_stm32_dcmi_set_frmival,
 	.get_frmival = video_stm32_dcmi_get_frmival,
+	.set_ctrl = video_stm32_dcmi_set_ctrl,
+	.set_selection = video_stm32_dcmi_set_selection,
+	.get_selection = video_stm32_dcmi_get_selection,
+#if defined(CONFIG_POLL)
+	.set_signal = video_stm32_dcmi_set_signal,
+#endif
 };
 
 static void video_stm32_dcmi_irq_config_func(const struct device *dev)
@@ -412,8 +1384,8 @@ static void video_stm32_dcmi_irq_config_func(const struct device *dev)
 			STM32_DMA_CHANNEL_CONFIG_BY_IDX(index, 0)),			\
 		.dest_data_size = STM32_DMA_CONFIG_##dest_dev##_DATA_SIZE(		\
 			STM32_DMA_CHANNEL_CONFIG_BY_IDX(index, 0)),			\
-		.source_burst_length = 1,						\
-		.dest_burst_length = 1,						\
+		.source_burst_length = DT_INST_PROP(index, dma_src_burst_length),	\
+		.dest_burst_length = DT_INST_PROP(index, dma_dest_burst_length),	\
 		.channel_priority = STM32_DMA_CONFIG_PRIORITY(				\
 			STM32_DMA_CHANNEL_CONFIG_BY_IDX(index, 0)),			\
 		.dma_callback = dcmi_dma_callback,					\
@@ -473,6 +1445,12 @@ static const struct video_stm32_dcmi_config video_stm32_dcmi_config_0 = {
 	.pctrl = PINCTRL_DT_INST_DEV_CONFIG_GET(0),
 	.sensor_dev = SOURCE_DEV(0),
 	DCMI_DMA_CHANNEL(0, PERIPHERAL, MEMORY)
+	.dma_profile = {
+		.src_burst = DT_INST_PROP(0, dma_src_burst_length),
+		.dest_burst = DT_INST_PROP(0, dma_dest_burst_length),
+		.src_port = DT_INST_PROP(0, dma_src_port),
+		.dest_port = DT_INST_PROP(0, dma_dest_port),
+	},
 };
 
 static int video_stm32_dcmi_init(const struct device *dev)
@@ -500,8 +1478,28 @@ static int video_stm32_dcmi_init(const struct device *dev)
 	}
 
 	data->dev = dev;
+
+	err = video_init_ctrl(&data->ctrls.hdecimation, dev, VIDEO_CID_STM32U5_DCMI_HDECIMATION,
+			      (struct video_ctrl_range){.min = 1, .max = 2, .step = 1, .def = 1});
+	if (err < 0) {
+		return err;
+	}
+
+	err = video_init_ctrl(&data->ctrls.vdecimation, dev, VIDEO_CID_STM32U5_DCMI_VDECIMATION,
+			      (struct video_ctrl_range){.min = 1, .max = 2, .step = 1, .def = 1});
+	if (err < 0) {
+		return err;
+	}
+
+	err = video_init_ctrl(&data->ctrls.luma_only, dev, VIDEO_CID_STM32U5_DCMI_LUMA_ONLY,
+			      (struct video_ctrl_range){.min = 0, .max = 1, .step = 1, .def = 0});
+	if (err < 0) {
+		return err;
+	}
+
 	k_fifo_init(&data->fifo_in);
 	k_fifo_init(&data->fifo_out);
+	k_work_init(&data->recover_work, stm32_dcmi_recover);
 	data->capture_rate = 1;
 
 	config->irq_config(dev);
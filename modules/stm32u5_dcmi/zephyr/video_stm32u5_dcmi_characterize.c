@@ -0,0 +1,162 @@
+/*
+ * DCMI throughput characterization for the out-of-tree STM32U5 DCMI driver.
+ * Streams a burst of frames for each (frame interval, GPDMA profile) pair
+ * and reports the bytes/s actually delivered, DCMI overruns and frames lost
+ * on the way, to find the bandwidth ceiling of a board/sensor setup.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/video.h>
+#include <zephyr/drivers/video/stm32u5_dcmi.h>
+
+LOG_MODULE_DECLARE(video_stm32u5_dcmi, CONFIG_VIDEO_LOG_LEVEL);
+
+/* Give up on a run when no frame arrives within this many frame intervals */
+#define STM32_DCMI_CHAR_TIMEOUT_FRAMES	4
+#define STM32_DCMI_CHAR_TIMEOUT_MIN_MS	200
+
+static int stm32_dcmi_char_run(const struct device *dev,
+			       struct video_stm32u5_dcmi_char_result *res, uint32_t num_frames)
+{
+	struct video_stm32u5_dcmi_stats stats;
+	struct video_buffer *vbuf;
+	uint64_t bytes = 0;
+	int64_t first_ms = 0;
+	int64_t last_ms = 0;
+	uint32_t frame_ms;
+	uint32_t expected;
+	int ret;
+
+	ret = video_stm32u5_dcmi_set_dma_profile(dev, &res->profile);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = video_set_frmival(dev, &res->frmival);
+	if (ret < 0) {
+		return ret;
+	}
+
+	frame_ms = DIV_ROUND_UP(res->frmival.numerator * MSEC_PER_SEC, res->frmival.denominator);
+
+	video_stm32u5_dcmi_get_stats(dev, &stats, true);
+
+	ret = video_stream_start(dev, VIDEO_BUF_TYPE_OUTPUT);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (res->frames < num_frames) {
+		k_timeout_t timeout = K_MSEC(MAX(STM32_DCMI_CHAR_TIMEOUT_FRAMES * frame_ms,
+						 STM32_DCMI_CHAR_TIMEOUT_MIN_MS));
+
+		/* Stop counting when frames dry up (e.g. errors faster than recovery) */
+		if (video_dequeue(dev, &vbuf, timeout) < 0) {
+			break;
+		}
+
+		last_ms = k_uptime_get();
+		if (res->frames == 0) {
+			/* Time from the first frame end: stream start-up is not throughput */
+			first_ms = last_ms;
+		} else {
+			bytes += vbuf->bytesused;
+		}
+		res->frames++;
+
+		video_enqueue(dev, vbuf);
+	}
+
+	video_stream_stop(dev, VIDEO_BUF_TYPE_OUTPUT);
+	while (video_dequeue(dev, &vbuf, K_NO_WAIT) == 0) {
+		video_enqueue(dev, vbuf);
+	}
+
+	video_stm32u5_dcmi_get_stats(dev, &stats, false);
+	res->overruns = stats.overruns;
+
+	res->elapsed_ms = last_ms - first_ms;
+	if (res->elapsed_ms > 0) {
+		res->bytes_per_sec = bytes * MSEC_PER_SEC / res->elapsed_ms;
+	}
+
+	/* Frame ends the sensor produced between the first and the last frame */
+	expected = res->elapsed_ms / MAX(frame_ms, 1U);
+	if (res->frames > 1 && expected > res->frames - 1) {
+		res->stalled_frames = expected - (res->frames - 1);
+	}
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_characterize(const struct device *dev,
+				    const struct video_stm32u5_dcmi_dma_profile *profiles,
+				    size_t num_profiles, uint32_t num_frames,
+				    video_stm32u5_dcmi_char_cb_t cb, void *user_data)
+{
+	struct video_format fmt = { .type = VIDEO_BUF_TYPE_OUTPUT };
+	struct video_frmival_enum fie = { .format = &fmt };
+	struct video_stm32u5_dcmi_dma_profile saved_profile;
+	struct video_frmival saved_frmival;
+	int ret;
+
+	if (num_profiles == 0 || num_frames < 2) {
+		return -EINVAL;
+	}
+
+	ret = video_get_format(dev, &fmt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = video_get_frmival(dev, &saved_frmival);
+	if (ret < 0) {
+		return ret;
+	}
+
+	video_stm32u5_dcmi_get_dma_profile(dev, &saved_profile);
+
+	LOG_INF("DCMI characterization: %ux%u, %u frames per run", fmt.width, fmt.height,
+		num_frames);
+
+	for (fie.index = 0; video_enum_frmival(dev, &fie) == 0; fie.index++) {
+		/* The DCMI reports each sensor interval as a stepwise range (frame skip) */
+		struct video_frmival frmival = fie.type == VIDEO_FRMIVAL_TYPE_DISCRETE ?
+					       fie.discrete : fie.stepwise.max;
+
+		for (size_t i = 0; i < num_profiles; i++) {
+			struct video_stm32u5_dcmi_char_result res = {
+				.profile = profiles[i],
+				.frmival = frmival,
+			};
+
+			ret = stm32_dcmi_char_run(dev, &res, num_frames);
+			if (ret < 0) {
+				LOG_ERR("Characterization run failed: %d", ret);
+				goto restore;
+			}
+
+			LOG_INF("%u/%u s burst %u/%u port %u/%u: %u frames, %u B/s, "
+				"%u overruns, %u stalled",
+				res.frmival.numerator, res.frmival.denominator,
+				res.profile.src_burst, res.profile.dest_burst,
+				res.profile.src_port, res.profile.dest_port,
+				res.frames, res.bytes_per_sec, res.overruns, res.stalled_frames);
+
+			if (cb != NULL) {
+				cb(dev, &res, user_data);
+			}
+		}
+	}
+
+restore:
+	video_stm32u5_dcmi_set_dma_profile(dev, &saved_profile);
+	video_set_frmival(dev, &saved_frmival);
+
+	return ret;
+}
@@ -0,0 +1,546 @@
+/*
+ * Emulated STM32U5 DCMI capture for native_sim.
+ * Compatible: st,stm32u5-dcmi-emul. Same video API and driver-specific API
+ * as video_stm32u5_dcmi.c, with the DCMI + GPDMA replaced by a timer that
+ * "captures" one frame per frame interval: a moving colour-bar pattern, or
+ * raw frames read from a host file given with --dcmi-frames=<path>.
+ *
+ * Buffer handling follows the hardware driver: the armed buffer is filled,
+ * swapped with the next enqueued one at frame end, and the frame is dropped
+ * (buffer kept as target) when nothing is enqueued.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT st_stm32u5_dcmi_emul
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/video.h>
+#include <zephyr/drivers/video/stm32u5_dcmi.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <cmdline.h>
+#include <nsi_host_trampolines.h>
+#include <posix_native_task.h>
+
+#include "video_device.h"
+
+LOG_MODULE_REGISTER(video_stm32u5_dcmi_emul, CONFIG_VIDEO_LOG_LEVEL);
+
+#define STM32_DCMI_EMUL_WIDTH_MAX	1920
+#define STM32_DCMI_EMUL_HEIGHT_MAX	1080
+#define STM32_DCMI_EMUL_FPS_MAX		120
+
+/* Host file of raw frames, looped; NULL = test pattern */
+static char *stm32_dcmi_emul_file;
+
+struct stm32_dcmi_emul_meta_slot {
+	const struct video_buffer *vbuf;
+	struct video_stm32u5_dcmi_frame_meta meta;
+};
+
+struct video_stm32_dcmi_emul_data {
+	const struct device *dev;
+	struct video_format fmt;
+	struct video_frmival frmival;
+	struct k_fifo fifo_in;
+	struct k_fifo fifo_out;
+	struct video_buffer *vbuf;
+	struct k_timer frame_timer;
+	struct k_work frame_work;
+	int host_fd;
+	struct video_stm32u5_dcmi_stats stats;
+	uint32_t sequence;
+	uint32_t dropped_since;
+	struct stm32_dcmi_emul_meta_slot meta[CONFIG_VIDEO_BUFFER_POOL_NUM_MAX];
+#if defined(CONFIG_POLL)
+	struct k_poll_signal *sig;
+#endif
+};
+
+struct video_stm32_dcmi_emul_config {
+	uint32_t frame_rate;
+};
+
+static const struct video_format_cap stm32_dcmi_emul_fmts[] = {
+	{
+		.pixelformat = VIDEO_PIX_FMT_RGB565,
+		.width_min = 2,
+		.width_max = STM32_DCMI_EMUL_WIDTH_MAX,
+		.height_min = 1,
+		.height_max = STM32_DCMI_EMUL_HEIGHT_MAX,
+		.width_step = 2,
+		.height_step = 1,
+	},
+	{0},
+};
+
+static inline void stm32_dcmi_emul_raise_signal(struct video_stm32_dcmi_emul_data *data,
+						int result)
+{
+#if defined(CONFIG_POLL)
+	if (data->sig != NULL) {
+		k_poll_signal_raise(data->sig, result);
+	}
+#endif
+}
+
+/*
+ * Eight vertical colour bars scrolling one pixel per frame, so consecutive
+ * frames differ. RGB565 big-endian, the byte order the app programs into
+ * the OV5640 on hardware.
+ */
+static void stm32_dcmi_emul_fill_pattern(const struct video_stm32_dcmi_emul_data *data,
+					 struct video_buffer *vbuf)
+{
+	static const uint16_t bars[] = {
+		0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000,
+	};
+	const struct video_format *fmt = &data->fmt;
+	uint32_t bar_w = MAX(fmt->width / ARRAY_SIZE(bars), 1U);
+
+	for (uint32_t y = 0; y < fmt->height; y++) {
+		uint16_t *row = (uint16_t *)(vbuf->buffer + y * fmt->pitch);
+
+		for (uint32_t x = 0; x < fmt->width; x++) {
+			uint32_t bar = ((x + data->sequence) / bar_w) % ARRAY_SIZE(bars);
+
+			row[x] = sys_cpu_to_be16(bars[bar]);
+		}
+	}
+}
+
+/* Next frame from the host file, rewinding at the end; false if unusable */
+static bool stm32_dcmi_emul_fill_file(struct video_stm32_dcmi_emul_data *data,
+				      struct video_buffer *vbuf)
+{
+	uint32_t size = data->fmt.pitch * data->fmt.height;
+
+	for (int attempt = 0; attempt < 2; attempt++) {
+		if (data->host_fd < 0) {
+			/* 0 = O_RDONLY on the host */
+			data->host_fd = nsi_host_open(stm32_dcmi_emul_file, 0);
+			if (data->host_fd < 0) {
+				LOG_ERR("Cannot open %s, using the test pattern",
+					stm32_dcmi_emul_file);
+				stm32_dcmi_emul_file = NULL;
+				return false;
+			}
+		}
+
+		if (nsi_host_read(data->host_fd, vbuf->buffer, size) == (long)size) {
+			return true;
+		}
+
+		/* End of file (or a partial last frame): loop from the start */
+		nsi_host_close(data->host_fd);
+		data->host_fd = -1;
+	}
+
+	LOG_ERR("%s holds no complete %u-byte frame, using the test pattern",
+		stm32_dcmi_emul_file, size);
+	stm32_dcmi_emul_file = NULL;
+
+	return false;
+}
+
+static void stm32_dcmi_emul_set_meta(struct video_stm32_dcmi_emul_data *data,
+				     const struct video_buffer *vbuf, uint32_t vsync_cycles)
+{
+	struct stm32_dcmi_emul_meta_slot *slot = NULL;
+
+	for (size_t i = 0; i < ARRAY_SIZE(data->meta); i++) {
+		if (data->meta[i].vbuf == vbuf) {
+			slot = &data->meta[i];
+			break;
+		}
+		if (slot == NULL && data->meta[i].vbuf == NULL) {
+			slot = &data->meta[i];
+		}
+	}
+
+	if (slot == NULL) {
+		return;
+	}
+
+	slot->vbuf = vbuf;
+	slot->meta.sequence = data->sequence;
+	slot->meta.vsync_cycles = vsync_cycles;
+	slot->meta.dropped = data->dropped_since;
+	data->dropped_since = 0;
+}
+
+/* One frame time elapsed: "capture" into the armed buffer and hand it out */
+static void stm32_dcmi_emul_frame(struct k_work *work)
+{
+	struct video_stm32_dcmi_emul_data *data =
+			CONTAINER_OF(work, struct video_stm32_dcmi_emul_data, frame_work);
+	uint32_t vsync_cycles = k_cycle_get_32();
+	uint32_t vsync_ms = k_uptime_get_32();
+	struct video_buffer *vbuf;
+
+	if (data->vbuf == NULL) {
+		return;
+	}
+
+	if (stm32_dcmi_emul_file == NULL || !stm32_dcmi_emul_fill_file(data, data->vbuf)) {
+		stm32_dcmi_emul_fill_pattern(data, data->vbuf);
+	}
+
+	vbuf = k_fifo_get(&data->fifo_in, K_NO_WAIT);
+	if (vbuf == NULL) {
+		LOG_DBG("Failed to get buffer from fifo");
+		data->stats.dropped++;
+		data->dropped_since++;
+	} else {
+		data->vbuf->timestamp = vsync_ms;
+		stm32_dcmi_emul_set_meta(data, data->vbuf, vsync_cycles);
+		k_fifo_put(&data->fifo_out, data->vbuf);
+		data->stats.frames++;
+		stm32_dcmi_emul_raise_signal(data, VIDEO_BUF_DONE);
+
+		data->vbuf = vbuf;
+	}
+
+	data->sequence++;
+}
+
+static void stm32_dcmi_emul_timer(struct k_timer *timer)
+{
+	struct video_stm32_dcmi_emul_data *data =
+			CONTAINER_OF(timer, struct video_stm32_dcmi_emul_data, frame_timer);
+
+	k_work_submit(&data->frame_work);
+}
+
+static k_timeout_t stm32_dcmi_emul_interval(const struct video_stm32_dcmi_emul_data *data)
+{
+	return K_USEC(video_frmival_nsec(&data->frmival) / NSEC_PER_USEC);
+}
+
+static int video_stm32_dcmi_emul_set_fmt(const struct device *dev, struct video_format *fmt)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	size_t idx;
+	int ret;
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	ret = video_format_caps_index(stm32_dcmi_emul_fmts, fmt, &idx);
+	if (ret < 0) {
+		LOG_ERR("Unsupported format %ux%u", fmt->width, fmt->height);
+		return ret;
+	}
+
+	fmt->pitch = fmt->width * video_bits_per_pixel(fmt->pixelformat) / BITS_PER_BYTE;
+	data->fmt = *fmt;
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_get_fmt(const struct device *dev, struct video_format *fmt)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+
+	*fmt = data->fmt;
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_set_stream(const struct device *dev, bool enable,
+					    enum video_buf_type type)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	struct k_work_sync sync;
+	k_timeout_t interval = stm32_dcmi_emul_interval(data);
+
+	if (!enable) {
+		k_timer_stop(&data->frame_timer);
+		k_work_cancel_sync(&data->frame_work, &sync);
+
+		/* Give the buffer that was armed as capture target back to the queue */
+		if (data->vbuf != NULL) {
+			k_fifo_put(&data->fifo_in, data->vbuf);
+			data->vbuf = NULL;
+			stm32_dcmi_emul_raise_signal(data, VIDEO_BUF_ABORTED);
+		}
+
+		return 0;
+	}
+
+	data->vbuf = k_fifo_get(&data->fifo_in, K_NO_WAIT);
+	if (data->vbuf == NULL) {
+		LOG_ERR("Failed to dequeue a DCMI buffer.");
+		return -ENOMEM;
+	}
+
+	/* Snapshot: a single frame per start, like the DCMI */
+	k_timer_start(&data->frame_timer, interval,
+		      IS_ENABLED(CONFIG_VIDEO_STM32U5_DCMI_CONTINUOUS) ? interval : K_NO_WAIT);
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_enqueue(const struct device *dev, struct video_buffer *vbuf)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	const uint32_t buffer_size = data->fmt.pitch * data->fmt.height;
+
+	if (buffer_size > vbuf->size) {
+		return -EINVAL;
+	}
+
+	vbuf->bytesused = buffer_size;
+	vbuf->line_offset = 0;
+
+	k_fifo_put(&data->fifo_in, vbuf);
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_dequeue(const struct device *dev, struct video_buffer **vbuf,
+					 k_timeout_t timeout)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+
+	*vbuf = k_fifo_get(&data->fifo_out, timeout);
+	if (*vbuf == NULL) {
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_get_caps(const struct device *dev, struct video_caps *caps)
+{
+	caps->format_caps = stm32_dcmi_emul_fmts;
+	caps->min_vbuf_count = 1;
+	caps->min_line_count = LINE_COUNT_HEIGHT;
+	caps->max_line_count = LINE_COUNT_HEIGHT;
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_enum_frmival(const struct device *dev,
+					      struct video_frmival_enum *fie)
+{
+	if (fie->index > 0) {
+		return -EINVAL;
+	}
+
+	fie->type = VIDEO_FRMIVAL_TYPE_STEPWISE;
+	fie->stepwise.min = (struct video_frmival){1, STM32_DCMI_EMUL_FPS_MAX};
+	fie->stepwise.max = (struct video_frmival){1, 1};
+	fie->stepwise.step = (struct video_frmival){1, STM32_DCMI_EMUL_FPS_MAX};
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_set_frmival(const struct device *dev,
+					     struct video_frmival *frmival)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	struct video_frmival_enum fie = {
+		.format = &data->fmt,
+		.discrete = *frmival,
+	};
+
+	video_closest_frmival(dev, &fie);
+	*frmival = fie.discrete;
+	data->frmival = fie.discrete;
+
+	/* Applies from the next frame when streaming */
+	if (data->vbuf != NULL && IS_ENABLED(CONFIG_VIDEO_STM32U5_DCMI_CONTINUOUS)) {
+		k_timeout_t interval = stm32_dcmi_emul_interval(data);
+
+		k_timer_start(&data->frame_timer, interval, interval);
+	}
+
+	return 0;
+}
+
+static int video_stm32_dcmi_emul_get_frmival(const struct device *dev,
+					     struct video_frmival *frmival)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+
+	*frmival = data->frmival;
+
+	return 0;
+}
+
+#if defined(CONFIG_POLL)
+static int video_stm32_dcmi_emul_set_signal(const struct device *dev, struct k_poll_signal *sig)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+
+	if (data->sig != NULL && sig != NULL) {
+		return -EALREADY;
+	}
+
+	data->sig = sig;
+
+	return 0;
+}
+#endif
+
+/* Driver-specific API (zephyr/drivers/video/stm32u5_dcmi.h) */
+
+int video_stm32u5_dcmi_flush(const struct device *dev)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	struct video_buffer *vbuf;
+
+	if (data->vbuf != NULL) {
+		return -EBUSY;
+	}
+
+	while ((vbuf = k_fifo_get(&data->fifo_in, K_NO_WAIT)) != NULL) {
+		k_fifo_put(&data->fifo_out, vbuf);
+	}
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_get_stats(const struct device *dev,
+				 struct video_stm32u5_dcmi_stats *stats, bool reset)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	unsigned int key;
+
+	key = irq_lock();
+	*stats = data->stats;
+	if (reset) {
+		data->stats = (struct video_stm32u5_dcmi_stats){0};
+	}
+	irq_unlock(key);
+
+	return 0;
+}
+
+int video_stm32u5_dcmi_get_frame_meta(const struct device *dev, const struct video_buffer *vbuf,
+				      struct video_stm32u5_dcmi_frame_meta *meta)
+{
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+	int ret = -ENOENT;
+	unsigned int key;
+
+	key = irq_lock();
+	for (size_t i = 0; i < ARRAY_SIZE(data->meta); i++) {
+		if (data->meta[i].vbuf == vbuf) {
+			*meta = data->meta[i].meta;
+			ret = 0;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	return ret;
+}
+
+/* No ISR, GPDMA or line bands to expose: report them as unsupported */
+int video_stm32u5_dcmi_get_isr_stats(const struct device *dev, enum video_stm32u5_dcmi_irq irq,
+				     struct video_stm32u5_dcmi_isr_stats *stats, bool reset)
+{
+	return -ENOTSUP;
+}
+
+int video_stm32u5_dcmi_set_band_callback(const struct device *dev,
+					 video_stm32u5_dcmi_band_cb_t cb, void *user_data)
+{
+	return -ENOTSUP;
+}
+
+int video_stm32u5_dcmi_set_dma_profile(const struct device *dev,
+				       const struct video_stm32u5_dcmi_dma_profile *profile)
+{
+	return -ENOTSUP;
+}
+
+int video_stm32u5_dcmi_get_dma_profile(const struct device *dev,
+				       struct video_stm32u5_dcmi_dma_profile *profile)
+{
+	return -ENOTSUP;
+}
+
+static DEVICE_API(video, video_stm32_dcmi_emul_driver_api) = {
+	.set_format = video_stm32_dcmi_emul_set_fmt,
+	.get_format = video_stm32_dcmi_emul_get_fmt,
+	.set_stream = video_stm32_dcmi_emul_set_stream,
+	.enqueue = video_stm32_dcmi_emul_enqueue,
+	.dequeue = video_stm32_dcmi_emul_dequeue,
+	.get_caps = video_stm32_dcmi_emul_get_caps,
+	.enum_frmival = video_stm32_dcmi_emul_enum_frmival,
+	.set_frmival = video_stm32_dcmi_emul_set_frmival,
+	.get_frmival = video_stm32_dcmi_emul_get_frmival,
+#if defined(CONFIG_POLL)
+	.set_signal = video_stm32_dcmi_emul_set_signal,
+#endif
+};
+
+static int video_stm32_dcmi_emul_init(const struct device *dev)
+{
+	const struct video_stm32_dcmi_emul_config *config = dev->config;
+	struct video_stm32_dcmi_emul_data *data = dev->data;
+
+	data->dev = dev;
+	data->host_fd = -1;
+	data->frmival = (struct video_frmival){1, config->frame_rate};
+
+	k_fifo_init(&data->fifo_in);
+	k_fifo_init(&data->fifo_out);
+	k_timer_init(&data->frame_timer, stm32_dcmi_emul_timer, NULL);
+	k_work_init(&data->frame_work, stm32_dcmi_emul_frame);
+
+	LOG_DBG("%s inited (%s)", dev->name,
+		stm32_dcmi_emul_file != NULL ? stm32_dcmi_emul_file : "test pattern");
+
+	return 0;
+}
+
+static void stm32_dcmi_emul_add_options(void)
+{
+	static struct args_struct_t opts[] = {
+		{
+			.option = "dcmi-frames",
+			.name = "path",
+			.type = 's',
+			.dest = (void *)&stm32_dcmi_emul_file,
+			.descript = "Raw RGB565 (big-endian) frames at the configured "
+				    "format, back to back, captured by the emulated DCMI "
+				    "in a loop instead of the test pattern",
+		},
+		ARG_TABLE_ENDMARKER,
+	};
+
+	native_add_command_line_opts(opts);
+}
+
+NATIVE_TASK(stm32_dcmi_emul_add_options, PRE_BOOT_1, 1);
+
+static struct video_stm32_dcmi_emul_data video_stm32_dcmi_emul_data_0 = {
+	.fmt = {
+		.type = VIDEO_BUF_TYPE_OUTPUT,
+		.pixelformat = VIDEO_PIX_FMT_RGB565,
+		.width = 160,
+		.height = 120,
+		.pitch = 160 * 2,
+	},
+};
+
+static const struct video_stm32_dcmi_emul_config video_stm32_dcmi_emul_config_0 = {
+	.frame_rate = DT_INST_PROP(0, frame_rate),
+};
+
+DEVICE_DT_INST_DEFINE(0, &video_stm32_dcmi_emul_init,
+		    NULL, &video_stm32_dcmi_emul_data_0,
+		    &video_stm32_dcmi_emul_config_0,
+		    POST_KERNEL, CONFIG_VIDEO_INIT_PRIORITY,
+		    &video_stm32_dcmi_emul_driver_api);
+
+VIDEO_DEVICE_DEFINE(dcmi_emul, DEVICE_DT_INST_GET(0), NULL);
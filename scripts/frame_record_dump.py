@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""Extract the frames recorded by CONFIG_APP_FRAME_RECORD (src/frame_record.h).
+
+Reads a flash image holding the frame log partition: the native_sim flash
+file (flash.bin) or a dump read from the target. Lists the records and
+saves every intact one as PNG (with Pillow) or PPM, oldest first.
+
+  frame_record_dump.py flash.bin --offset 0x100000 --size 0x100000 --out frames/
+  frame_record_dump.py partition.bin --page-size 8192 --list
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from frame_stream_rx import CODEC_QOI565, CODEC_RAW, decode_qoi565, save, to_rgb888  # noqa: E402
+
+PAGE_MAGIC = b"KKRP"
+PAGE_HEADER = struct.Struct("<4sIIHHI")
+RECORD_MAGIC = b"KKFR"
+RECORD_HEADER = struct.Struct("<4sBBBBHHIQII")
+VERSION = 1
+NONE = 0xFFFF
+FLAGS = {1: "periodic", 2: "requested", 3: "periodic+requested"}
+
+
+def read_pages(image, page_size):
+    """Valid pages as (seq, first record offset, data), oldest first."""
+    pages = []
+    for off in range(0, len(image) - page_size + 1, page_size):
+        page = image[off:off + page_size]
+        magic, seq, _, first, _, crc = PAGE_HEADER.unpack_from(page)
+        if magic != PAGE_MAGIC or zlib.crc32(page[:16]) != crc:
+            continue
+        pages.append((seq, first, page))
+    if not pages:
+        return []
+    # Sequence numbers are contiguous from the oldest page on, modulo 2^32
+    newest = max(pages, key=lambda p: p[0])[0]
+    pages.sort(key=lambda p: (p[0] - newest - 1) & 0xFFFFFFFF)
+    return pages
+
+
+def records(pages):
+    """Yield (header fields, payload or None if damaged) for every record."""
+    stream = bytearray()
+    # Stream offset of each page start and of its first record
+    starts = []
+    for seq, first, page in pages:
+        base = len(stream) - PAGE_HEADER.size
+        starts.append((seq, base + first if first != NONE else None, len(stream)))
+        stream += page[PAGE_HEADER.size:]
+    ends = [s[2] for s in starts[1:]] + [len(stream)]
+
+    def next_record(i):
+        """First record at or after page i, as (page index, stream offset)."""
+        for j in range(i, len(starts)):
+            if starts[j][1] is not None:
+                return j, starts[j][1]
+        return len(starts), None
+
+    i, pos = next_record(0)
+    while pos is not None:
+        if ends[i] - pos < RECORD_HEADER.size:
+            i, pos = next_record(i + 1)
+            continue
+        fields = RECORD_HEADER.unpack_from(stream, pos)
+        magic, version, _, _, _, width, height, _, _, length, crc = fields
+        end = pos + RECORD_HEADER.size + length
+        if magic != RECORD_MAGIC or version != VERSION or width * height == 0:
+            i, pos = next_record(i + 1)
+            continue
+        # Pages in the span must follow each other without a gap
+        last = i
+        while last < len(ends) - 1 and ends[last] < end:
+            last += 1
+        contiguous = all(starts[k + 1][0] == (starts[k][0] + 1) & 0xFFFFFFFF
+                         for k in range(i, last))
+        payload = bytes(stream[pos + RECORD_HEADER.size:end])
+        if not contiguous or end > len(stream) or zlib.crc32(payload) != crc:
+            yield fields, None
+            i, pos = next_record(i + 1)
+            continue
+        yield fields, payload
+        pos = end
+        i = last
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="flash image or partition dump")
+    parser.add_argument("--offset", type=lambda v: int(v, 0), default=0,
+                        help="partition offset in the image")
+    parser.add_argument("--size", type=lambda v: int(v, 0),
+                        help="partition size (default: rest of the image)")
+    parser.add_argument("--page-size", type=lambda v: int(v, 0), default=4096,
+                        help="flash erase page size (4096 flash simulator, 8192 STM32U5)")
+    parser.add_argument("--out", metavar="DIR", help="save the frames to DIR")
+    parser.add_argument("--list", action="store_true", help="only list the records")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    end = args.offset + args.size if args.size else len(image)
+    pages = read_pages(image[args.offset:end], args.page_size)
+    print("%d pages in use" % len(pages))
+
+    if args.out and not args.list:
+        os.makedirs(args.out, exist_ok=True)
+
+    good = 0
+    bad = 0
+    for fields, payload in records(pages):
+        _, _, codec, flags, _, width, height, seq, uptime_ms, length, _ = fields
+        state = "ok" if payload is not None else "damaged"
+        print("#%-6u %10.3f s  %ux%u  %s  %u bytes (%u%% of raw)  %s" % (
+            seq, uptime_ms / 1000.0, width, height, FLAGS.get(flags, "-"), length,
+            100 * length // (width * height * 2), state))
+        if payload is None:
+            bad += 1
+            continue
+        good += 1
+        if args.list or not args.out:
+            continue
+        if codec == CODEC_RAW:
+            pixels = struct.unpack(">%dH" % (width * height), payload)
+        elif codec == CODEC_QOI565:
+            pixels = decode_qoi565(payload, width * height)
+        else:
+            print("#%u: unknown codec %d" % (seq, codec), file=sys.stderr)
+            continue
+        save(args.out, seq, width, height, to_rgb888(pixels))
+
+    print("%d records, %d damaged" % (good, bad))
+
+
+if __name__ == "__main__":
+    main()
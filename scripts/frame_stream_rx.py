@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""Receive frames sent by CONFIG_APP_FRAME_STREAM (src/frame_stream.h).
+
+Reads packets from a serial port or a native_sim pty, checks their CRC,
+decodes them and saves each frame (PPM, or PNG with Pillow) and/or shows
+the live stream in a Tk window.
+
+  frame_stream_rx.py /dev/pts/5 --show
+  frame_stream_rx.py /dev/ttyACM0 --baud 921600 --save frames/
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"KKFS"
+HEADER = struct.Struct("<4sBBHHIII")
+VERSION = 1
+CODEC_RAW = 0
+CODEC_QOI565 = 1
+# Larger than any frame the application can stream
+MAX_PAYLOAD = 480 * 480 * 2
+
+
+def open_port(path, baud):
+    """Serial port through pyserial when available, else a raw tty (pty)."""
+    try:
+        import serial
+
+        return serial.Serial(path, baud, timeout=1)
+    except ImportError:
+        import termios
+        import tty
+
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+        if os.isatty(fd):
+            tty.setraw(fd)
+            attrs = termios.tcgetattr(fd)
+            attrs[6][termios.VMIN] = 1
+            attrs[6][termios.VTIME] = 0
+            termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return os.fdopen(fd, "rb", buffering=0)
+
+
+def read_exact(port, n):
+    data = bytearray()
+    while len(data) < n:
+        chunk = port.read(n - len(data))
+        if not chunk:
+            continue
+        data += chunk
+    return bytes(data)
+
+
+def sync(port):
+    """Skip to the byte after the next magic."""
+    window = b""
+    while window != MAGIC:
+        window = (window + read_exact(port, 1))[-len(MAGIC):]
+
+
+def decode_qoi565(data, count):
+    """QOI-style RGB565 ops to a list of 16-bit pixels."""
+    index = [0] * 64
+    prev = 0
+    out = []
+    i = 0
+    while len(out) < count:
+        op = data[i]
+        i += 1
+        if op == 0xFE:
+            px = (data[i] << 8) | data[i + 1]
+            i += 2
+        elif op >= 0xC0:
+            out.extend([prev] * ((op & 0x3F) + 1))
+            continue
+        elif op >= 0x80:
+            dg = (op & 0x3F) - 32
+            dr = (data[i] >> 4) - 8 + dg
+            db = (data[i] & 0x0F) - 8 + dg
+            i += 1
+            px = pack(r565(prev) + dr, g565(prev) + dg, b565(prev) + db)
+        elif op >= 0x40:
+            dr = ((op >> 4) & 3) - 2
+            dg = ((op >> 2) & 3) - 2
+            db = (op & 3) - 2
+            px = pack(r565(prev) + dr, g565(prev) + dg, b565(prev) + db)
+        else:
+            px = index[op]
+        index[(r565(px) * 3 + g565(px) * 5 + b565(px) * 7) % 64] = px
+        out.append(px)
+        prev = px
+    if len(out) != count or i != len(data):
+        raise ValueError("payload does not match the frame size")
+    return out
+
+
+def r565(px):
+    return px >> 11
+
+
+def g565(px):
+    return (px >> 5) & 0x3F
+
+
+def b565(px):
+    return px & 0x1F
+
+
+def pack(r, g, b):
+    if not (0 <= r < 32 and 0 <= g < 64 and 0 <= b < 32):
+        raise ValueError("channel out of range")
+    return (r << 11) | (g << 5) | b
+
+
+def to_rgb888(pixels):
+    rgb = bytearray(len(pixels) * 3)
+    for i, px in enumerate(pixels):
+        r, g, b = r565(px), g565(px), b565(px)
+        rgb[3 * i] = (r << 3) | (r >> 2)
+        rgb[3 * i + 1] = (g << 2) | (g >> 4)
+        rgb[3 * i + 2] = (b << 3) | (b >> 2)
+    return bytes(rgb)
+
+
+def ppm(width, height, rgb):
+    return b"P6\n%d %d\n255\n" % (width, height) + rgb
+
+
+def read_frame(port):
+    """Next good frame as (seq, width, height, payload length, RGB888 bytes)."""
+    while True:
+        sync(port)
+        _, version, codec, width, height, seq, length, crc = HEADER.unpack(
+            MAGIC + read_exact(port, HEADER.size - len(MAGIC)))
+        if version != VERSION or length > MAX_PAYLOAD or width * height == 0:
+            print("bad header, resyncing", file=sys.stderr)
+            continue
+        payload = read_exact(port, length)
+        if zlib.crc32(payload) != crc:
+            print("seq %d: CRC mismatch" % seq, file=sys.stderr)
+            continue
+        try:
+            if codec == CODEC_RAW:
+                pixels = struct.unpack(">%dH" % (width * height), payload)
+            elif codec == CODEC_QOI565:
+                pixels = decode_qoi565(payload, width * height)
+            else:
+                raise ValueError("unknown codec %d" % codec)
+        except (ValueError, IndexError, struct.error) as err:
+            print("seq %d: %s" % (seq, err), file=sys.stderr)
+            continue
+        return seq, width, height, length, to_rgb888(pixels)
+
+
+def save(directory, seq, width, height, rgb):
+    try:
+        from PIL import Image
+
+        path = os.path.join(directory, "frame_%08d.png" % seq)
+        Image.frombytes("RGB", (width, height), rgb).save(path)
+    except ImportError:
+        path = os.path.join(directory, "frame_%08d.ppm" % seq)
+        with open(path, "wb") as f:
+            f.write(ppm(width, height, rgb))
+
+
+class Viewer:
+    """Tk window showing the latest frame (PPM data needs no extra package)."""
+
+    def __init__(self, scale):
+        import tkinter
+
+        self.tk = tkinter
+        self.root = tkinter.Tk()
+        self.root.title("frame stream")
+        self.label = tkinter.Label(self.root)
+        self.label.pack()
+        self.scale = scale
+        self.image = None
+
+    def show(self, width, height, rgb):
+        image = self.tk.PhotoImage(data=ppm(width, height, rgb), format="PPM")
+        if self.scale > 1:
+            image = image.zoom(self.scale)
+        self.image = image
+        self.label.configure(image=image)
+        self.root.update()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="serial device or native_sim pty (/dev/pts/N)")
+    parser.add_argument("--baud", type=int, default=921600)
+    parser.add_argument("--save", metavar="DIR", help="write every frame to DIR")
+    parser.add_argument("--show", action="store_true", help="show frames in a window")
+    parser.add_argument("--zoom", type=int, default=2, help="window zoom factor")
+    args = parser.parse_args()
+
+    if args.save:
+        os.makedirs(args.save, exist_ok=True)
+    viewer = Viewer(args.zoom) if args.show else None
+    port = open_port(args.port, args.baud)
+
+    last_seq = None
+    start = time.monotonic()
+    frames = 0
+    payload = 0
+    while True:
+        seq, width, height, length, rgb = read_frame(port)
+        if last_seq is not None and seq != last_seq + 1:
+            print("skipped %d frame(s) before seq %d" % (seq - last_seq - 1, seq),
+                  file=sys.stderr)
+        last_seq = seq
+        frames += 1
+        payload += length
+
+        if args.save:
+            save(args.save, seq, width, height, rgb)
+        if viewer:
+            viewer.show(width, height, rgb)
+
+        elapsed = time.monotonic() - start
+        if elapsed >= 1.0:
+            print("%ux%u %.1f fps, %.0f%% of raw" % (width, height, frames / elapsed,
+                  100.0 * payload / (frames * width * height * 2)))
+            start = time.monotonic()
+            frames = 0
+            payload = 0
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
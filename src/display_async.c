@@ -0,0 +1,202 @@
+/*
+ * Asynchronous, multi-buffered display output (see display_async.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "display_async.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(display_async, LOG_LEVEL_INF);
+
+#define DISPLAY_ASYNC_STACKSIZE  1024
+#define DISPLAY_ASYNC_PRIORITY   7
+
+struct display_async_req {
+	uint8_t *buf;
+	uint16_t x;
+	uint16_t y;
+	struct display_buffer_descriptor desc;
+	uint8_t num_rects;
+	struct display_async_rect rects[DISPLAY_ASYNC_MAX_RECTS];
+};
+
+/* Submitted buffers in display order, and buffers free to compose into */
+K_MSGQ_DEFINE(display_async_req_msgq, sizeof(struct display_async_req),
+	      DISPLAY_ASYNC_MAX_BUFS, 4);
+K_MSGQ_DEFINE(display_async_free_msgq, sizeof(uint8_t *), DISPLAY_ASYNC_MAX_BUFS, 4);
+
+static K_SEM_DEFINE(display_async_started, 0, 1);
+
+static const struct device *display_async_dev;
+static display_async_done_cb_t display_async_cb;
+static void *display_async_user_data;
+static uint8_t *display_async_bufs[DISPLAY_ASYNC_MAX_BUFS];
+static size_t display_async_num_bufs;
+/* Buffer the completion callback held, display thread only */
+static uint8_t *display_async_held;
+static uint32_t display_async_last_cycles;
+
+int display_async_init(const struct device *disp, uint8_t *const *bufs, size_t num_bufs,
+		       display_async_done_cb_t cb, void *user_data)
+{
+	if (num_bufs > DISPLAY_ASYNC_MAX_BUFS) {
+		return -EINVAL;
+	}
+
+	if (display_async_dev != NULL) {
+		return -EALREADY;
+	}
+
+	display_async_dev = disp;
+	display_async_cb = cb;
+	display_async_user_data = user_data;
+
+	for (size_t i = 0; i < num_bufs; i++) {
+		display_async_bufs[i] = bufs[i];
+		k_msgq_put(&display_async_free_msgq, &bufs[i], K_NO_WAIT);
+	}
+	display_async_num_bufs = num_bufs;
+
+	k_sem_give(&display_async_started);
+
+	return 0;
+}
+
+uint32_t display_async_busy_cycles(void)
+{
+	return display_async_last_cycles;
+}
+
+uint32_t display_async_busy_usec(void)
+{
+	return k_cyc_to_us_floor32(display_async_last_cycles);
+}
+
+uint8_t *display_async_get_buffer(k_timeout_t timeout)
+{
+	uint8_t *buf;
+
+	if (k_msgq_get(&display_async_free_msgq, &buf, timeout) != 0) {
+		return NULL;
+	}
+
+	return buf;
+}
+
+int display_async_submit_rects(uint8_t *buf, uint16_t x, uint16_t y,
+			       const struct display_buffer_descriptor *desc,
+			       const struct display_async_rect *rects, size_t num_rects,
+			       k_timeout_t timeout)
+{
+	struct display_async_req req = {
+		.buf = buf,
+		.x = x,
+		.y = y,
+		.desc = *desc,
+		.num_rects = num_rects,
+	};
+
+	if (num_rects > DISPLAY_ASYNC_MAX_RECTS) {
+		return -EINVAL;
+	}
+
+	memcpy(req.rects, rects, num_rects * sizeof(rects[0]));
+
+	return k_msgq_put(&display_async_req_msgq, &req, timeout) == 0 ? 0 : -EAGAIN;
+}
+
+int display_async_submit(uint8_t *buf, uint16_t x, uint16_t y,
+			 const struct display_buffer_descriptor *desc, k_timeout_t timeout)
+{
+	const struct display_async_rect all = {
+		.w = desc->width,
+		.h = desc->height,
+	};
+
+	return display_async_submit_rects(buf, x, y, desc, &all, 1, timeout);
+}
+
+/* Write each rectangle of a request straight from the buffer, using its pitch */
+static int display_async_write_rects(const struct display_async_req *req)
+{
+	const size_t bpp = req->desc.buf_size / (req->desc.pitch * req->desc.height);
+	int ret = 0;
+
+	for (size_t i = 0; i < req->num_rects && ret == 0; i++) {
+		const struct display_async_rect *r = &req->rects[i];
+		struct display_buffer_descriptor desc = {
+			.buf_size = ((r->h - 1) * req->desc.pitch + r->w) * bpp,
+			.width = r->w,
+			.height = r->h,
+			.pitch = req->desc.pitch,
+			/* Lets frame-buffered panels defer the refresh to the last part */
+			.frame_incomplete = i + 1 < req->num_rects,
+		};
+
+		ret = display_write(display_async_dev, req->x + r->x, req->y + r->y, &desc,
+				    req->buf + (r->y * req->desc.pitch + r->x) * bpp);
+	}
+
+	return ret;
+}
+
+void display_async_hold(uint8_t *buf)
+{
+	display_async_held = buf;
+}
+
+void display_async_release(uint8_t *buf)
+{
+	/* Never blocks: the free list has room for every buffer */
+	k_msgq_put(&display_async_free_msgq, &buf, K_NO_WAIT);
+}
+
+/* True for the buffers handed over at init, which cycle through the free list */
+static bool display_async_owns(const uint8_t *buf)
+{
+	for (size_t i = 0; i < display_async_num_bufs; i++) {
+		if (display_async_bufs[i] == buf) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Write submitted buffers in order; sleeps on the SPI DMA transfer meanwhile */
+static void display_async_thread(void)
+{
+	struct display_async_req req;
+	uint32_t start;
+	int ret;
+
+	k_sem_take(&display_async_started, K_FOREVER);
+
+	while (1) {
+		k_msgq_get(&display_async_req_msgq, &req, K_FOREVER);
+
+		start = k_cycle_get_32();
+		ret = display_async_write_rects(&req);
+		display_async_last_cycles = k_cycle_get_32() - start;
+		if (ret < 0) {
+			LOG_ERR("display_write failed: %d", ret);
+		}
+
+		if (display_async_cb != NULL) {
+			display_async_cb(req.buf, ret, display_async_user_data);
+		}
+
+		/* A held buffer comes back through display_async_release() */
+		if (display_async_owns(req.buf) && req.buf != display_async_held) {
+			k_msgq_put(&display_async_free_msgq, &req.buf, K_FOREVER);
+		}
+		display_async_held = NULL;
+	}
+}
+
+K_THREAD_DEFINE(display_async_id, DISPLAY_ASYNC_STACKSIZE, display_async_thread, NULL, NULL,
+		NULL, DISPLAY_ASYNC_PRIORITY, 0, 0);
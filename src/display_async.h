@@ -0,0 +1,118 @@
+/*
+ * Asynchronous, multi-buffered display output.
+ *
+ * display_write() blocks its caller for the whole panel transfer (SPI DMA
+ * on the target). Here it runs in a dedicated thread that sleeps on that
+ * transfer, so the caller composes the next frame into another buffer
+ * meanwhile. Buffers cycle: get a free one, fill it, submit it; it comes
+ * back to the free list once the panel has it, unless the completion
+ * callback holds it for a later display_async_release(). Buffers the caller
+ * owns (e.g. a captured video frame) can be submitted too: they are handed
+ * back through the completion callback only.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DISPLAY_ASYNC_H_
+#define DISPLAY_ASYNC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Most buffers display_async_init() accepts */
+#define DISPLAY_ASYNC_MAX_BUFS  2
+/* Most rectangles one display_async_submit_rects() call can carry */
+#define DISPLAY_ASYNC_MAX_RECTS 16
+
+/* Part of a submitted buffer, in pixels from the buffer's top-left corner */
+struct display_async_rect {
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+};
+
+/*
+ * Called from the display thread after buf has been written to the panel,
+ * just before buf goes back to the free list. ret is display_write()'s.
+ * Runs on the display thread's small stack, next to the panel driver:
+ * keep it to bookkeeping (no logging, no encoding).
+ */
+typedef void (*display_async_done_cb_t)(uint8_t *buf, int ret, void *user_data);
+
+/**
+ * Hand the output buffers to the display thread and start it. Call once.
+ *
+ * @param disp      Display device
+ * @param bufs      Output buffers, all free (may be NULL if num_bufs is 0)
+ * @param num_bufs  Number of buffers (0..DISPLAY_ASYNC_MAX_BUFS); with 0,
+ *                  only caller-owned buffers are submitted
+ * @param cb        Completion callback (may be NULL)
+ * @param user_data Passed to cb
+ * @retval 0 on success, -EINVAL for a bad buffer count, -EALREADY if started
+ */
+int display_async_init(const struct device *disp, uint8_t *const *bufs, size_t num_bufs,
+		       display_async_done_cb_t cb, void *user_data);
+
+/**
+ * Take a free output buffer to compose into.
+ *
+ * @retval Buffer, or NULL if none got free within timeout
+ */
+uint8_t *display_async_get_buffer(k_timeout_t timeout);
+
+/**
+ * Queue buf (from display_async_get_buffer(), or caller-owned) for
+ * display_write() at (x, y) and return without waiting for the transfer.
+ * buf belongs to the display thread until the completion callback.
+ *
+ * @retval 0 on success, -EAGAIN if the queue did not free up within timeout
+ */
+int display_async_submit(uint8_t *buf, uint16_t x, uint16_t y,
+			 const struct display_buffer_descriptor *desc, k_timeout_t timeout);
+
+/**
+ * Like display_async_submit(), but only write the given parts of buf, one
+ * display_write() per rectangle. desc describes the whole buffer (its pitch
+ * is used to step through each rectangle). With num_rects = 0 nothing is
+ * written: buf just goes back to the free list through the callback.
+ *
+ * @retval 0 on success, -EINVAL for too many rectangles, -EAGAIN if the
+ *         queue did not free up within timeout
+ */
+int display_async_submit_rects(uint8_t *buf, uint16_t x, uint16_t y,
+			       const struct display_buffer_descriptor *desc,
+			       const struct display_async_rect *rects, size_t num_rects,
+			       k_timeout_t timeout);
+
+/**
+ * From the completion callback: keep buf (one of the buffers given at
+ * init) off the free list until display_async_release(), e.g. while
+ * another thread still reads it.
+ */
+void display_async_hold(uint8_t *buf);
+
+/* Put a buffer held with display_async_hold() back on the free list. */
+void display_async_release(uint8_t *buf);
+
+/**
+ * Time the display thread spent writing the request being completed, in
+ * microseconds. Only meaningful from the completion callback.
+ */
+uint32_t display_async_busy_usec(void);
+
+/* Same as display_async_busy_usec(), in k_cycle_get_32() cycles. */
+uint32_t display_async_busy_cycles(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_ASYNC_H_ */
@@ -0,0 +1,121 @@
+/*
+ * Lossless RGB565 frame codec (see frame_codec.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame_codec.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+
+#define FRAME_CODEC_OP_INDEX   0x00
+#define FRAME_CODEC_OP_DIFF    0x40
+#define FRAME_CODEC_OP_LUMA    0x80
+#define FRAME_CODEC_OP_RUN     0xC0
+#define FRAME_CODEC_OP_RAW     0xFE
+/* 0xFE and 0xFF stay free in the run range */
+#define FRAME_CODEC_RUN_MAX    62
+
+static inline uint8_t frame_codec_hash(uint16_t px)
+{
+	return ((px >> 11) * 3 + ((px >> 5) & 0x3F) * 5 + (px & 0x1F) * 7) % 64;
+}
+
+/* QOI-style encode; returns the output size or -ENOSPC */
+static int frame_codec_qoi(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch,
+			       uint8_t *out, size_t size)
+{
+	uint16_t index[64] = { 0 };
+	uint16_t prev = 0;
+	uint8_t run = 0;
+	size_t n = 0;
+
+	for (uint16_t y = 0; y < h; y++) {
+		const uint16_t *s = (const uint16_t *)buf + y * pitch;
+
+		for (uint16_t x = 0; x < w; x++) {
+			const uint16_t px = sys_be16_to_cpu(s[x]);
+
+			/* A pending run and the longest op */
+			if (size - n < 4) {
+				return -ENOSPC;
+			}
+
+			if (px == prev) {
+				if (++run == FRAME_CODEC_RUN_MAX) {
+					out[n++] = FRAME_CODEC_OP_RUN | (run - 1);
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0) {
+				out[n++] = FRAME_CODEC_OP_RUN | (run - 1);
+				run = 0;
+			}
+
+			const uint8_t hash = frame_codec_hash(px);
+
+			if (index[hash] == px) {
+				out[n++] = FRAME_CODEC_OP_INDEX | hash;
+				prev = px;
+				continue;
+			}
+			index[hash] = px;
+
+			const int dr = (int)(px >> 11) - (int)(prev >> 11);
+			const int dg = (int)((px >> 5) & 0x3F) - (int)((prev >> 5) & 0x3F);
+			const int db = (int)(px & 0x1F) - (int)(prev & 0x1F);
+
+			if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+				out[n++] = FRAME_CODEC_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 |
+					   (db + 2);
+			} else if (dg >= -32 && dg <= 31 && dr - dg >= -8 && dr - dg <= 7 &&
+				   db - dg >= -8 && db - dg <= 7) {
+				out[n++] = FRAME_CODEC_OP_LUMA | (dg + 32);
+				out[n++] = (dr - dg + 8) << 4 | (db - dg + 8);
+			} else {
+				out[n++] = FRAME_CODEC_OP_RAW;
+				out[n++] = px >> 8;
+				out[n++] = px & 0xFF;
+			}
+			prev = px;
+		}
+	}
+
+	if (run > 0) {
+		if (n == size) {
+			return -ENOSPC;
+		}
+		out[n++] = FRAME_CODEC_OP_RUN | (run - 1);
+	}
+
+	return n;
+}
+
+int frame_codec_encode(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch,
+		       uint8_t *out, size_t size, enum frame_codec *codec)
+{
+	const size_t raw = (size_t)w * h * sizeof(uint16_t);
+	int len = frame_codec_qoi(buf, w, h, pitch, out, size);
+
+	if (len >= 0 && (size_t)len < raw) {
+		*codec = FRAME_CODEC_QOI565;
+		return len;
+	}
+
+	/* Noise does not compress: the raw frame is never larger */
+	if (raw > size) {
+		return -ENOSPC;
+	}
+
+	for (uint16_t y = 0; y < h; y++) {
+		memcpy(&out[y * w * sizeof(uint16_t)], buf + y * pitch * sizeof(uint16_t),
+		       w * sizeof(uint16_t));
+	}
+	*codec = FRAME_CODEC_RAW;
+
+	return raw;
+}
@@ -0,0 +1,55 @@
+/*
+ * Lossless RGB565 frame codec for the frame stream and recorder.
+ *
+ * Codec 0 is raw big-endian RGB565. Codec 1 (QOI-style) works on the
+ * 5/6/5 channels, starting from a black previous pixel and an all-zero
+ * 64-entry index, one byte per op:
+ *   00iiiiii              previous pixel with index hash i
+ *   01rrggbb              channel deltas from the previous pixel, -2..1 (+2)
+ *   10gggggg rrrrbbbb     green delta -32..31 (+32), red/blue delta
+ *                         minus green delta -8..7 (+8)
+ *   11llllll              previous pixel repeated l + 1 times (1..62)
+ *   0xFE hi lo            pixel as is
+ * Index hash: (r * 3 + g * 5 + b * 7) % 64, updated for every pixel but
+ * runs. It needs no previous frame, so encoding costs no frame buffer.
+ * scripts/frame_stream_rx.py has the matching decoder.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_CODEC_H_
+#define FRAME_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum frame_codec {
+	FRAME_CODEC_RAW = 0,
+	FRAME_CODEC_QOI565 = 1,
+};
+
+/**
+ * Compress a frame (big-endian RGB565), or copy it raw when it does not
+ * shrink: the output is never larger than the raw frame.
+ *
+ * @param buf   Top-left pixel
+ * @param w     Width in pixels
+ * @param h     Height in pixels
+ * @param pitch Line length in pixels
+ * @param out   Output buffer
+ * @param size  Output buffer size
+ * @param codec Set to the codec used
+ * @retval Output size, or -ENOSPC if the frame does not fit in size
+ */
+int frame_codec_encode(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch,
+		       uint8_t *out, size_t size, enum frame_codec *codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_CODEC_H_ */
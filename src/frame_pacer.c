@@ -0,0 +1,163 @@
+/*
+ * Adaptive frame pacing (see frame_pacer.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame_pacer.h"
+
+#include <errno.h>
+#include <zephyr/drivers/video.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+LOG_MODULE_REGISTER(frame_pacer, LOG_LEVEL_INF);
+
+/* Decision window */
+#define FRAME_PACER_WINDOW_MS      1000
+/* Slow down when the busiest stage uses more than this share of the interval */
+#define FRAME_PACER_HIGH_PCT       90
+/* Speed up when it would use less than this share of the faster interval */
+#define FRAME_PACER_LOW_PCT        70
+/* ... for this many windows in a row, without drops */
+#define FRAME_PACER_UP_WINDOWS     3
+
+struct frame_pacer {
+	const struct device *dev;
+	uint32_t target_fps;
+	/* Current divider: frame interval = div / target_fps */
+	uint32_t div;
+	uint32_t max_div;
+	uint32_t next_div;
+	uint32_t calm_windows;
+	int64_t window_start_ms;
+	uint32_t frames;
+	uint32_t dropped;
+	atomic_t stage_usec[FRAME_PACER_STAGES];
+	atomic_t stage_count[FRAME_PACER_STAGES];
+	/* Per-stage average of the last window, for the log */
+	uint32_t stage_avg_usec[FRAME_PACER_STAGES];
+};
+
+static struct frame_pacer pacer;
+
+static uint32_t frame_pacer_interval_usec(uint32_t div)
+{
+	return div * USEC_PER_SEC / pacer.target_fps;
+}
+
+int frame_pacer_init(const struct device *dev, uint32_t target_fps, uint32_t min_fps)
+{
+	int ret;
+
+	if (target_fps == 0 || min_fps == 0 || min_fps > target_fps) {
+		return -EINVAL;
+	}
+
+	pacer.dev = dev;
+	pacer.target_fps = target_fps;
+	pacer.div = 1;
+	pacer.next_div = 1;
+	pacer.max_div = target_fps / min_fps;
+	pacer.calm_windows = 0;
+	pacer.window_start_ms = k_uptime_get();
+	pacer.frames = 0;
+	pacer.dropped = 0;
+
+	for (int i = 0; i < FRAME_PACER_STAGES; i++) {
+		atomic_clear(&pacer.stage_usec[i]);
+		atomic_clear(&pacer.stage_count[i]);
+		pacer.stage_avg_usec[i] = 0;
+	}
+
+	ret = frame_pacer_apply();
+	if (ret < 0) {
+		/* The device cannot change its frame interval: stay idle */
+		pacer.dev = NULL;
+	}
+
+	return ret;
+}
+
+void frame_pacer_stage_time(enum frame_pacer_stage stage, uint32_t usec)
+{
+	atomic_add(&pacer.stage_usec[stage], usec);
+	atomic_inc(&pacer.stage_count[stage]);
+}
+
+void frame_pacer_frame(uint32_t dropped)
+{
+	pacer.frames++;
+	pacer.dropped += dropped;
+}
+
+bool frame_pacer_update(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t busiest = 0;
+
+	if (pacer.dev == NULL || now - pacer.window_start_ms < FRAME_PACER_WINDOW_MS) {
+		return false;
+	}
+
+	for (int i = 0; i < FRAME_PACER_STAGES; i++) {
+		atomic_val_t usec = atomic_clear(&pacer.stage_usec[i]);
+		atomic_val_t count = atomic_clear(&pacer.stage_count[i]);
+
+		pacer.stage_avg_usec[i] = count > 0 ? (uint32_t)usec / (uint32_t)count : 0;
+		busiest = MAX(busiest, pacer.stage_avg_usec[i]);
+	}
+
+	if (pacer.dropped > 0 ||
+	    busiest * 100U > frame_pacer_interval_usec(pacer.div) * FRAME_PACER_HIGH_PCT) {
+		/* Overloaded: capture outruns compose or the panel */
+		pacer.calm_windows = 0;
+		pacer.next_div = MIN(pacer.div + 1, pacer.max_div);
+	} else if (pacer.div > 1 && busiest * 100U <
+		   frame_pacer_interval_usec(pacer.div - 1) * FRAME_PACER_LOW_PCT) {
+		if (++pacer.calm_windows >= FRAME_PACER_UP_WINDOWS) {
+			pacer.calm_windows = 0;
+			pacer.next_div = pacer.div - 1;
+		}
+	} else {
+		pacer.calm_windows = 0;
+	}
+
+	LOG_DBG("window: %u frames, %u dropped, compose %u us, panel %u us", pacer.frames,
+		pacer.dropped, pacer.stage_avg_usec[FRAME_PACER_COMPOSE],
+		pacer.stage_avg_usec[FRAME_PACER_PANEL]);
+
+	pacer.window_start_ms = now;
+	pacer.frames = 0;
+	pacer.dropped = 0;
+
+	return pacer.next_div != pacer.div;
+}
+
+int frame_pacer_apply(void)
+{
+	struct video_frmival frmival = {
+		.numerator = pacer.next_div,
+		.denominator = pacer.target_fps,
+	};
+	int ret;
+
+	/* The DCMI driver picks the closest sensor interval x capture rate */
+	ret = video_set_frmival(pacer.dev, &frmival);
+	if (ret < 0) {
+		LOG_ERR("Failed to set frame interval %u/%u: %d", pacer.next_div,
+			pacer.target_fps, ret);
+		pacer.next_div = pacer.div;
+		return ret;
+	}
+
+	pacer.div = pacer.next_div;
+
+	LOG_INF("Pacing: %u/%u s asked, %u/%u s set (compose %u us, panel %u us)",
+		pacer.div, pacer.target_fps, frmival.numerator, frmival.denominator,
+		pacer.stage_avg_usec[FRAME_PACER_COMPOSE],
+		pacer.stage_avg_usec[FRAME_PACER_PANEL]);
+
+	return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Adaptive frame pacing.
+ *
+ * Runs capture at target_fps / n for the smallest n the pipeline keeps up
+ * with. Once per window it compares the busiest stage's time per frame
+ * (reported by the stages) and the frames the DCMI dropped against the
+ * frame interval. It steps n up at once on overload and down again after a
+ * few windows with ample headroom. The DCMI driver turns each interval
+ * into a sensor frame interval plus a DCMI capture rate (frame skip).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_PACER_H_
+#define FRAME_PACER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pipeline stages whose time per frame is paced against the frame interval */
+enum frame_pacer_stage {
+	FRAME_PACER_COMPOSE,
+	FRAME_PACER_PANEL,
+	FRAME_PACER_STAGES,
+};
+
+/**
+ * Choose the starting operating point (target_fps) and set it on the video
+ * device. Call with the stream stopped.
+ *
+ * @param dev        Video device (DCMI)
+ * @param target_fps Highest frame rate to run at
+ * @param min_fps    Lowest frame rate the pacer may fall back to
+ * @retval 0 on success or a negative error code from video_set_frmival()
+ */
+int frame_pacer_init(const struct device *dev, uint32_t target_fps, uint32_t min_fps);
+
+/* Report the time one stage spent on one frame (any thread). */
+void frame_pacer_stage_time(enum frame_pacer_stage stage, uint32_t usec);
+
+/* Count one delivered frame and the frames dropped before it (capture thread). */
+void frame_pacer_frame(uint32_t dropped);
+
+/**
+ * Close the window once it is due and decide on the operating point.
+ *
+ * @retval true when the frame interval should change: stop the stream, call
+ *         frame_pacer_apply(), start it again
+ */
+bool frame_pacer_update(void);
+
+/**
+ * Set the operating point picked by frame_pacer_update() on the video
+ * device and log it. Call with the stream stopped (the DCMI capture rate
+ * only changes at stream start).
+ *
+ * @retval 0 on success or a negative error code from video_set_frmival()
+ */
+int frame_pacer_apply(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_PACER_H_ */
@@ -0,0 +1,462 @@
+/*
+ * On-device frame recorder to a flash ring buffer (see frame_record.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame_record.h"
+#include "frame_codec.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_REGISTER(frame_record, LOG_LEVEL_INF);
+
+#define FRAME_RECORD_STACKSIZE  1024
+/* Below the camera pipeline and the frame stream: erases take milliseconds */
+#define FRAME_RECORD_PRIORITY   11
+
+/*
+ * Write a part-filled page after this long without records, unless the
+ * next periodic record is due before a whole period has gone by: it goes
+ * into the same page
+ */
+#define FRAME_RECORD_IDLE_FLUSH_MS  5000
+/* Log the write throughput this often while recording */
+#define FRAME_RECORD_REPORT_MS      10000
+
+#define FRAME_RECORD_NONE       0xFFFF
+
+static const uint8_t frame_record_page_magic[4] = { 'K', 'K', 'R', 'P' };
+static const uint8_t frame_record_magic[4] = { 'K', 'K', 'F', 'R' };
+
+enum frame_record_evt {
+	FRAME_RECORD_EVT_RECORD,
+	FRAME_RECORD_EVT_FLUSH,
+	/* No event for FRAME_RECORD_IDLE_FLUSH_MS */
+	FRAME_RECORD_EVT_IDLE,
+};
+
+K_MSGQ_DEFINE(frame_record_msgq, sizeof(uint8_t), 4, 1);
+
+static K_SEM_DEFINE(frame_record_started, 0, 1);
+
+/* Header and payload of the record being appended */
+static uint8_t frame_record_buf[CONFIG_APP_FRAME_RECORD_BUF_SIZE] __aligned(4);
+static size_t frame_record_len;
+/* Set from the frame picked until its record is in the page buffer or on flash */
+static atomic_t frame_record_busy;
+static atomic_t frame_record_requested;
+
+/* Frame picked, read by the thread until the done callback */
+static const uint8_t *frame_record_frame;
+static uint16_t frame_record_w;
+static uint16_t frame_record_h;
+static uint16_t frame_record_pitch;
+static uint8_t frame_record_flags;
+static int64_t frame_record_frame_ms;
+
+static frame_record_done_cb_t frame_record_done_cb;
+static void *frame_record_user_data;
+
+static uint32_t frame_record_period_ms;
+static int64_t frame_record_last_ms;
+
+/* Flash log, thread only after init */
+static const struct flash_area *frame_record_fa;
+static size_t frame_record_page_size;
+static uint32_t frame_record_num_pages;
+static uint32_t frame_record_cur_page;
+static uint32_t frame_record_page_seq;
+static uint32_t frame_record_seq;
+
+/* RAM copy of the page being filled */
+static uint8_t *frame_record_page;
+static size_t frame_record_fill;
+static uint16_t frame_record_first;
+
+static struct k_spinlock frame_record_lock;
+static struct frame_record_stats frame_record_counters;
+static int64_t frame_record_stats_ms;
+
+/* Go on after the valid page with the highest sequence, if any */
+static int frame_record_recover(const struct flash_area *fa)
+{
+	uint8_t hdr[FRAME_RECORD_PAGE_HEADER];
+	bool found = false;
+	uint32_t last = 0;
+	int ret;
+
+	for (uint32_t i = 0; i < frame_record_num_pages; i++) {
+		ret = flash_area_read(fa, i * frame_record_page_size, hdr, sizeof(hdr));
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (memcmp(hdr, frame_record_page_magic, sizeof(frame_record_page_magic)) != 0 ||
+		    crc32_ieee(hdr, 16) != sys_get_le32(&hdr[16])) {
+			continue;
+		}
+
+		const uint32_t seq = sys_get_le32(&hdr[4]);
+
+		if (!found || (int32_t)(seq - frame_record_page_seq) >= 0) {
+			found = true;
+			last = i;
+			frame_record_page_seq = seq;
+			frame_record_seq = sys_get_le32(&hdr[8]);
+		}
+	}
+
+	if (found) {
+		frame_record_cur_page = (last + 1) % frame_record_num_pages;
+		frame_record_page_seq++;
+	}
+
+	return 0;
+}
+
+/* Erase and write the page buffer, padded, then start the next page */
+static int frame_record_write_page(void)
+{
+	const off_t off = (off_t)frame_record_cur_page * frame_record_page_size;
+	uint8_t *page = frame_record_page;
+	uint32_t start;
+	k_spinlock_key_t key;
+	int ret;
+
+	memset(&page[frame_record_fill], 0xFF, frame_record_page_size - frame_record_fill);
+	memcpy(page, frame_record_page_magic, sizeof(frame_record_page_magic));
+	sys_put_le32(frame_record_page_seq, &page[4]);
+	sys_put_le32(frame_record_seq, &page[8]);
+	sys_put_le16(frame_record_first, &page[12]);
+	sys_put_le16(0xFFFF, &page[14]);
+	sys_put_le32(crc32_ieee(page, 16), &page[16]);
+
+	start = k_cycle_get_32();
+	ret = flash_area_erase(frame_record_fa, off, frame_record_page_size);
+	if (ret == 0) {
+		ret = flash_area_write(frame_record_fa, off, page, frame_record_page_size);
+	}
+
+	key = k_spin_lock(&frame_record_lock);
+	frame_record_counters.pages++;
+	frame_record_counters.flash_bytes += frame_record_page_size;
+	frame_record_counters.flash_us += k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	k_spin_unlock(&frame_record_lock, key);
+
+	if (ret < 0) {
+		LOG_ERR("Frame log page %u not written: %d", frame_record_cur_page, ret);
+	}
+
+	/* A failed page is skipped: its records fail their CRC on readout */
+	frame_record_cur_page = (frame_record_cur_page + 1) % frame_record_num_pages;
+	frame_record_page_seq++;
+	frame_record_fill = FRAME_RECORD_PAGE_HEADER;
+	frame_record_first = FRAME_RECORD_NONE;
+
+	return ret;
+}
+
+/* Copy a record into the page buffer, writing every page it fills */
+static int frame_record_append(uint8_t *rec, size_t len)
+{
+	int ret = 0;
+
+	/* Record headers never span pages */
+	if (frame_record_page_size - frame_record_fill < FRAME_RECORD_HEADER) {
+		ret = frame_record_write_page();
+	}
+
+	if (frame_record_first == FRAME_RECORD_NONE) {
+		frame_record_first = frame_record_fill;
+	}
+	sys_put_le32(frame_record_seq++, &rec[12]);
+
+	while (len > 0) {
+		const size_t n = MIN(len, frame_record_page_size - frame_record_fill);
+
+		memcpy(&frame_record_page[frame_record_fill], rec, n);
+		frame_record_fill += n;
+		rec += n;
+		len -= n;
+
+		if (frame_record_fill == frame_record_page_size) {
+			int err = frame_record_write_page();
+
+			ret = ret < 0 ? ret : err;
+		}
+	}
+
+	return ret;
+}
+
+int frame_record_init(uint8_t area_id, uint32_t period_ms, frame_record_done_cb_t cb,
+		      void *user_data)
+{
+	const struct flash_area *fa;
+	struct flash_pages_info info;
+	int ret;
+
+	if (frame_record_fa != NULL) {
+		return -EALREADY;
+	}
+
+	ret = flash_area_open(area_id, &fa);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Pages are taken as uniform over the partition (STM32U5, flash simulator) */
+	ret = flash_get_page_info_by_offs(flash_area_get_device(fa), fa->fa_off, &info);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	if (info.size < FRAME_RECORD_PAGE_HEADER + FRAME_RECORD_HEADER ||
+	    info.size > UINT16_MAX || fa->fa_size % info.size != 0 ||
+	    fa->fa_size / info.size < 2) {
+		ret = -EINVAL;
+		goto fail;
+	}
+
+	frame_record_page_size = info.size;
+	frame_record_num_pages = fa->fa_size / info.size;
+
+	ret = frame_record_recover(fa);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	frame_record_page = k_malloc(frame_record_page_size);
+	if (frame_record_page == NULL) {
+		ret = -ENOMEM;
+		goto fail;
+	}
+
+	frame_record_fill = FRAME_RECORD_PAGE_HEADER;
+	frame_record_first = FRAME_RECORD_NONE;
+	frame_record_done_cb = cb;
+	frame_record_user_data = user_data;
+	frame_record_period_ms = period_ms;
+	frame_record_last_ms = k_uptime_get();
+	frame_record_stats_ms = frame_record_last_ms;
+
+	LOG_INF("Frame log: %u pages of %u bytes, next page %u, next record %u",
+		frame_record_num_pages, (uint32_t)frame_record_page_size, frame_record_cur_page,
+		frame_record_seq);
+
+	/* Last: frames are taken from here on */
+	frame_record_fa = fa;
+	k_sem_give(&frame_record_started);
+
+	return 0;
+
+fail:
+	flash_area_close(fa);
+
+	return ret;
+}
+
+void frame_record_request(void)
+{
+	atomic_set(&frame_record_requested, 1);
+}
+
+void frame_record_flush(void)
+{
+	uint8_t evt = FRAME_RECORD_EVT_FLUSH;
+
+	k_msgq_put(&frame_record_msgq, &evt, K_NO_WAIT);
+}
+
+bool frame_record_submit(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch)
+{
+	const int64_t now = k_uptime_get();
+	const uint8_t evt = FRAME_RECORD_EVT_RECORD;
+	k_spinlock_key_t key;
+	uint8_t flags = 0;
+
+	if (frame_record_fa == NULL) {
+		return false;
+	}
+
+	if (atomic_get(&frame_record_requested) != 0) {
+		flags |= FRAME_RECORD_REQUESTED;
+	}
+	if (frame_record_period_ms > 0 && now - frame_record_last_ms >= frame_record_period_ms) {
+		flags |= FRAME_RECORD_PERIODIC;
+	}
+	if (flags == 0) {
+		return false;
+	}
+
+	/* Kept pending: the next frame is tried again */
+	if (!atomic_cas(&frame_record_busy, 0, 1)) {
+		key = k_spin_lock(&frame_record_lock);
+		frame_record_counters.busy++;
+		k_spin_unlock(&frame_record_lock, key);
+		return false;
+	}
+
+	frame_record_frame = buf;
+	frame_record_w = w;
+	frame_record_h = h;
+	frame_record_pitch = pitch;
+	frame_record_flags = flags;
+	frame_record_frame_ms = now;
+	if (k_msgq_put(&frame_record_msgq, &evt, K_NO_WAIT) != 0) {
+		atomic_clear(&frame_record_busy);
+		return false;
+	}
+
+	atomic_clear(&frame_record_requested);
+	if ((flags & FRAME_RECORD_PERIODIC) != 0) {
+		frame_record_last_ms = now;
+	}
+
+	return true;
+}
+
+/* Encode the frame picked into a record and hand the frame back; <0 if too big */
+static int frame_record_encode(void)
+{
+	uint8_t *payload = &frame_record_buf[FRAME_RECORD_HEADER];
+	const uint16_t w = frame_record_w;
+	const uint16_t h = frame_record_h;
+	enum frame_codec codec;
+	k_spinlock_key_t key;
+	int len;
+
+	len = frame_codec_encode(frame_record_frame, w, h, frame_record_pitch, payload,
+				 sizeof(frame_record_buf) - FRAME_RECORD_HEADER, &codec);
+	if (frame_record_done_cb != NULL) {
+		frame_record_done_cb(frame_record_frame, frame_record_user_data);
+	}
+
+	if (len < 0) {
+		key = k_spin_lock(&frame_record_lock);
+		frame_record_counters.too_big++;
+		k_spin_unlock(&frame_record_lock, key);
+		return len;
+	}
+
+	/* The sequence is set on append, in append order */
+	memcpy(frame_record_buf, frame_record_magic, sizeof(frame_record_magic));
+	frame_record_buf[4] = FRAME_RECORD_VERSION;
+	frame_record_buf[5] = codec;
+	frame_record_buf[6] = frame_record_flags;
+	frame_record_buf[7] = 0xFF;
+	sys_put_le16(w, &frame_record_buf[8]);
+	sys_put_le16(h, &frame_record_buf[10]);
+	sys_put_le64(frame_record_frame_ms, &frame_record_buf[16]);
+	sys_put_le32(len, &frame_record_buf[24]);
+	sys_put_le32(crc32_ieee(payload, len), &frame_record_buf[28]);
+	frame_record_len = FRAME_RECORD_HEADER + len;
+
+	key = k_spin_lock(&frame_record_lock);
+	frame_record_counters.payload_bytes += len;
+	frame_record_counters.raw_bytes += (uint32_t)w * h * sizeof(uint16_t);
+	k_spin_unlock(&frame_record_lock, key);
+
+	return len;
+}
+
+void frame_record_get_stats(struct frame_record_stats *stats, bool reset)
+{
+	const int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&frame_record_lock);
+
+	*stats = frame_record_counters;
+	stats->elapsed_ms = now - frame_record_stats_ms;
+	if (reset) {
+		memset(&frame_record_counters, 0, sizeof(frame_record_counters));
+		frame_record_stats_ms = now;
+	}
+
+	k_spin_unlock(&frame_record_lock, key);
+}
+
+/* Log what the flash sustained over the last ms milliseconds */
+static void frame_record_report(struct frame_record_stats *last, uint32_t ms)
+{
+	struct frame_record_stats now;
+	uint32_t bytes;
+	uint32_t flash_us;
+
+	frame_record_get_stats(&now, false);
+	bytes = now.flash_bytes - last->flash_bytes;
+	flash_us = now.flash_us - last->flash_us;
+
+	if (bytes > 0 && flash_us > 0 && ms > 0) {
+		LOG_INF("Frame log: %u records, %u KiB at %u KiB/s (%u KiB/s while writing, "
+			"flash busy %u%%), %u busy, %u too big",
+			now.records - last->records, bytes / 1024,
+			(uint32_t)((uint64_t)bytes * 1000U / 1024U / ms),
+			(uint32_t)((uint64_t)bytes * 1000000U / 1024U / flash_us),
+			(uint32_t)((uint64_t)flash_us / 10U / ms), now.busy - last->busy,
+			now.too_big - last->too_big);
+	}
+
+	*last = now;
+}
+
+/* Encode and append records and write pages; only this thread touches the flash */
+static void frame_record_thread(void)
+{
+	struct frame_record_stats last;
+	int64_t periodic_ms = 0;
+	bool periodic = false;
+	int64_t report_ms;
+	k_spinlock_key_t key;
+	uint8_t evt;
+	int ret;
+
+	k_sem_take(&frame_record_started, K_FOREVER);
+
+	frame_record_get_stats(&last, false);
+	report_ms = k_uptime_get();
+
+	while (1) {
+		if (k_msgq_get(&frame_record_msgq, &evt, K_MSEC(FRAME_RECORD_IDLE_FLUSH_MS)) != 0) {
+			evt = FRAME_RECORD_EVT_IDLE;
+		}
+
+		if (evt == FRAME_RECORD_EVT_RECORD) {
+			if ((frame_record_flags & FRAME_RECORD_PERIODIC) != 0) {
+				periodic = true;
+				periodic_ms = frame_record_frame_ms;
+			}
+			ret = frame_record_encode();
+			if (ret >= 0) {
+				ret = frame_record_append(frame_record_buf, frame_record_len);
+			}
+			atomic_clear(&frame_record_busy);
+			if (ret == 0) {
+				key = k_spin_lock(&frame_record_lock);
+				frame_record_counters.records++;
+				k_spin_unlock(&frame_record_lock, key);
+			}
+		} else if (evt == FRAME_RECORD_EVT_FLUSH || !periodic ||
+			   k_uptime_get() - periodic_ms >= frame_record_period_ms) {
+			/* Otherwise the next periodic record goes into this page */
+			if (frame_record_fill > FRAME_RECORD_PAGE_HEADER) {
+				frame_record_write_page();
+			}
+		}
+
+		if (k_uptime_get() - report_ms >= FRAME_RECORD_REPORT_MS) {
+			frame_record_report(&last, k_uptime_get() - report_ms);
+			report_ms = k_uptime_get();
+		}
+	}
+}
+
+K_THREAD_DEFINE(frame_record_id, FRAME_RECORD_STACKSIZE, frame_record_thread, NULL, NULL, NULL,
+		FRAME_RECORD_PRIORITY, 0, 0);
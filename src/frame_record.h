@@ -0,0 +1,115 @@
+/*
+ * On-device frame recorder: a circular log of compressed frames on a
+ * flash partition.
+ *
+ * Frames are picked every period_ms and on request (frame_record_request()),
+ * then encoded (frame_codec.h) into a record buffer and appended to the log
+ * by a low-priority thread. The caller keeps a frame picked unchanged until
+ * the done callback, which comes right after the encode. The thread batches
+ * records into a RAM copy of one flash page and erases and writes whole,
+ * page-aligned pages only. A frame picked while the previous record is still
+ * being encoded or written is skipped. The oldest page is overwritten when
+ * the log wraps.
+ *
+ * Page: header, then the next bytes of the record stream (records span
+ * pages; a record header never does, the rest of the page is padded
+ * with 0xFF instead):
+ *   magic "KKRP" | page sequence u32 | next record sequence u32 |
+ *   offset of the first record header in the page u16 (0xFFFF: none) |
+ *   0xFFFF | CRC-32 (IEEE) of the 16 bytes before u32
+ *
+ * Record (little-endian):
+ *   magic "KKFR" | version u8 | codec u8 | flags u8 | 0xFF | width u16 |
+ *   height u16 | sequence u32 | uptime ms u64 | payload length u32 |
+ *   CRC-32 (IEEE) of payload u32 | payload
+ *
+ * At init the page with the highest sequence is found, and the log goes
+ * on after it. The tail of the last record stays in RAM until its page
+ * fills, until frame_record_flush() or after a few idle seconds. While
+ * periodic records keep coming the log is not idle, so they share pages.
+ * scripts/frame_record_dump.py extracts the frames from a flash image.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_RECORD_H_
+#define FRAME_RECORD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_RECORD_VERSION      1
+#define FRAME_RECORD_PAGE_HEADER  20
+#define FRAME_RECORD_HEADER       32
+
+/* Record flags: why the frame was recorded */
+#define FRAME_RECORD_PERIODIC     (1U << 0)
+#define FRAME_RECORD_REQUESTED    (1U << 1)
+
+/* Counters since init or the last reset */
+struct frame_record_stats {
+	/* Records appended */
+	uint32_t records;
+	/* Frames skipped because the previous record was still being written */
+	uint32_t busy;
+	/* Frames skipped because they did not fit in the record buffer */
+	uint32_t too_big;
+	/* Payload and raw bytes of the records appended */
+	uint32_t payload_bytes;
+	uint32_t raw_bytes;
+	/* Pages (and bytes) erased and written, and the time spent doing it */
+	uint32_t pages;
+	uint32_t flash_bytes;
+	uint32_t flash_us;
+	/* Time the counters cover */
+	uint32_t elapsed_ms;
+};
+
+/* Called from the recorder thread once it no longer reads a frame it picked */
+typedef void (*frame_record_done_cb_t)(const uint8_t *buf, void *user_data);
+
+/**
+ * Open the log on a flash partition and start recording. Call once.
+ *
+ * @param area_id   Partition (FIXED_PARTITION_ID())
+ * @param period_ms Record one frame every period_ms, 0 for requested
+ *                  frames only
+ * @param cb        Frame done callback (may be NULL)
+ * @param user_data Passed to cb
+ * @retval 0 on success, -EALREADY if started, -EINVAL if the partition is
+ *         not whole pages, -ENOMEM if the page buffer cannot be
+ *         allocated, or a flash error
+ */
+int frame_record_init(uint8_t area_id, uint32_t period_ms, frame_record_done_cb_t cb,
+		      void *user_data);
+
+/**
+ * Offer a composed frame (big-endian RGB565). Only picks it: the recorder
+ * thread encodes it later.
+ *
+ * @param buf   Top-left pixel
+ * @param w     Width in pixels
+ * @param h     Height in pixels
+ * @param pitch Line length in pixels
+ * @retval true if picked: buf must stay unchanged until the done callback
+ */
+bool frame_record_submit(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch);
+
+/** Record the next frame offered, besides the periodic ones. */
+void frame_record_request(void);
+
+/** Write the page in RAM now, so every record so far is on flash. */
+void frame_record_flush(void);
+
+/** Read (and optionally clear) the recorder counters. */
+void frame_record_get_stats(struct frame_record_stats *stats, bool reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_RECORD_H_ */
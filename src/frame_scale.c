@@ -0,0 +1,245 @@
+/*
+ * Fixed-point RGB565 frame scaler (see frame_scale.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame_scale.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+/* RGB565 with green moved to the upper half: 5 spare bits above every channel */
+#define FRAME_SCALE_SPREAD_MASK  0x07E0F81Fu
+#define FRAME_SCALE_WEIGHT_BITS  5
+#define FRAME_SCALE_WEIGHT_ONE   BIT(FRAME_SCALE_WEIGHT_BITS)
+
+static inline uint32_t frame_scale_spread(uint16_t px)
+{
+	uint32_t v = sys_be16_to_cpu(px);
+
+	return (v | (v << 16)) & FRAME_SCALE_SPREAD_MASK;
+}
+
+static inline uint16_t frame_scale_pack(uint32_t v)
+{
+	return sys_cpu_to_be16((uint16_t)(v | (v >> 16)));
+}
+
+/* a + (b - a) * w / 32 on the three channels at once */
+static inline uint32_t frame_scale_lerp(uint32_t a, uint32_t b, uint32_t w)
+{
+	return ((a * (FRAME_SCALE_WEIGHT_ONE - w) + b * w) >> FRAME_SCALE_WEIGHT_BITS) &
+	       FRAME_SCALE_SPREAD_MASK;
+}
+
+/* Two pixels in one 32-bit word, p0 first in memory */
+static inline uint32_t frame_scale_pair(uint16_t p0, uint16_t p1)
+{
+#if defined(CONFIG_BIG_ENDIAN)
+	return ((uint32_t)p0 << 16) | p1;
+#else
+	return ((uint32_t)p1 << 16) | p0;
+#endif
+}
+
+/*
+ * Write px(0) .. px(n - 1) from d on, two pixels per 32-bit store when d
+ * is word aligned.
+ */
+#define FRAME_SCALE_SPAN(d, n, px)						\
+	do {									\
+		uint16_t _i = 0;						\
+										\
+		if (((uintptr_t)(d) & 3) == 0) {				\
+			uint32_t *_d32 = (uint32_t *)(d);			\
+										\
+			for (; _i + 1 < (n); _i += 2) {				\
+				*_d32++ = frame_scale_pair(px(_i), px(_i + 1));	\
+			}							\
+		}								\
+		for (; _i < (n); _i++) {					\
+			(d)[_i] = px(_i);					\
+		}								\
+	} while (0)
+
+/* Source index and next-index weight of every destination index, 16.16 fixed point */
+static void frame_scale_table(uint16_t *idx, uint8_t *weight, uint16_t src, uint16_t dst,
+			      enum frame_scale_filter filter, bool mirror)
+{
+	const uint32_t step = ((uint32_t)src << 16) / dst;
+	/* Centre of destination pixel 0, in source pixels */
+	int32_t pos = (int32_t)(step / 2);
+
+	if (filter == FRAME_SCALE_BILINEAR) {
+		/* Blend between the centres around it */
+		pos -= 1 << 15;
+	}
+
+	for (uint16_t i = 0; i < dst; i++, pos += step) {
+		/* Centres are symmetric: a mirror only walks the table backwards */
+		uint16_t j = mirror ? dst - 1 - i : i;
+		int32_t p = MAX(pos, 0);
+
+		idx[j] = p >> 16;
+		weight[j] = filter == FRAME_SCALE_BILINEAR ?
+			    (p >> (16 - FRAME_SCALE_WEIGHT_BITS)) & (FRAME_SCALE_WEIGHT_ONE - 1) : 0;
+		if (idx[j] >= src - 1) {
+			idx[j] = src - 1;
+			weight[j] = 0;
+		}
+	}
+}
+
+int frame_scale_init(struct frame_scale *fs, uint16_t src_w, uint16_t src_h, uint16_t dst_w,
+		     uint16_t dst_h, enum frame_scale_filter filter, uint8_t orient)
+{
+	const bool transpose = (orient & FRAME_SCALE_TRANSPOSE) != 0;
+
+	if (src_w == 0 || src_h == 0 || dst_w == 0 || dst_h == 0 ||
+	    src_w > FRAME_SCALE_MAX_DIM || src_h > FRAME_SCALE_MAX_DIM ||
+	    dst_w > FRAME_SCALE_MAX_DIM || dst_h > FRAME_SCALE_MAX_DIM) {
+		return -EINVAL;
+	}
+
+	fs->src_w = src_w;
+	fs->src_h = src_h;
+	fs->dst_w = dst_w;
+	fs->dst_h = dst_h;
+	fs->filter = filter;
+	fs->orient = orient;
+	fs->line_row = UINT16_MAX;
+
+	/* Transposed: source columns follow destination rows and vice versa */
+	frame_scale_table(fs->col, fs->col_w, src_w, transpose ? dst_h : dst_w, filter,
+			  (orient & (transpose ? FRAME_SCALE_MIRROR_Y : FRAME_SCALE_MIRROR_X)) != 0);
+	frame_scale_table(fs->row, fs->row_w, src_h, transpose ? dst_w : dst_h, filter,
+			  (orient & (transpose ? FRAME_SCALE_MIRROR_X : FRAME_SCALE_MIRROR_Y)) != 0);
+
+	return 0;
+}
+
+static void frame_scale_row_nearest(const struct frame_scale *fs, const uint16_t *s,
+				    uint16_t *d)
+{
+#define FRAME_SCALE_PX(i) s[fs->col[i]]
+	FRAME_SCALE_SPAN(d, fs->dst_w, FRAME_SCALE_PX);
+#undef FRAME_SCALE_PX
+}
+
+/* Vertical pass: blend source rows y and y + 1 into fs->line */
+static void frame_scale_fill_line(struct frame_scale *fs, const uint8_t *src, size_t src_pitch,
+				  uint16_t y, uint8_t w)
+{
+	const uint16_t *s0 = (const uint16_t *)(src + y * src_pitch);
+	const uint16_t *s1 = w != 0 ? (const uint16_t *)(src + (y + 1) * src_pitch) : s0;
+
+	if (fs->line_row == y && fs->line_w == w) {
+		return;
+	}
+
+	for (uint16_t x = 0; x < fs->src_w; x++) {
+		fs->line[x] = frame_scale_lerp(frame_scale_spread(s0[x]),
+					       frame_scale_spread(s1[x]), w);
+	}
+	/* Lets the last column read one past the end */
+	fs->line[fs->src_w] = fs->line[fs->src_w - 1];
+
+	fs->line_row = y;
+	fs->line_w = w;
+}
+
+/* Horizontal pass from fs->line */
+static void frame_scale_row_bilinear(const struct frame_scale *fs, uint16_t *d)
+{
+	const uint32_t *l = fs->line;
+
+#define FRAME_SCALE_PX(i) \
+	frame_scale_pack(frame_scale_lerp(l[fs->col[i]], l[fs->col[i] + 1], fs->col_w[i]))
+	FRAME_SCALE_SPAN(d, fs->dst_w, FRAME_SCALE_PX);
+#undef FRAME_SCALE_PX
+}
+
+/* Source pixel at (column c, row r) */
+#define FRAME_SCALE_SRC(c, r) \
+	(*(const uint16_t *)(src + (r) * src_pitch + (c) * sizeof(uint16_t)))
+
+/* Bilinear pixel from source columns c0/c1 and rows r0/r1 */
+static inline uint16_t frame_scale_bilinear_px(const uint8_t *src, size_t src_pitch,
+					       uint16_t c0, uint16_t c1, uint8_t cw,
+					       uint16_t r0, uint16_t r1, uint8_t rw)
+{
+	const uint32_t top = frame_scale_lerp(frame_scale_spread(FRAME_SCALE_SRC(c0, r0)),
+					      frame_scale_spread(FRAME_SCALE_SRC(c1, r0)), cw);
+	const uint32_t bottom = frame_scale_lerp(frame_scale_spread(FRAME_SCALE_SRC(c0, r1)),
+						 frame_scale_spread(FRAME_SCALE_SRC(c1, r1)), cw);
+
+	return frame_scale_pack(frame_scale_lerp(top, bottom, rw));
+}
+
+/*
+ * Transposed orientations: destination row y reads source column col[y]
+ * and destination column x source row row[x]. Tile by tile, so the source
+ * rows a tile reads are still cached when its next row reads them again.
+ */
+static void frame_scale_rows_transposed(const struct frame_scale *fs, const uint8_t *src,
+					size_t src_pitch, uint8_t *dst, size_t dst_pitch,
+					uint16_t row, uint16_t end)
+{
+	for (uint16_t ty = row; ty < end; ty += FRAME_SCALE_TILE) {
+		const uint16_t th = MIN(FRAME_SCALE_TILE, end - ty);
+
+		for (uint16_t tx = 0; tx < fs->dst_w; tx += FRAME_SCALE_TILE) {
+			const uint16_t tw = MIN(FRAME_SCALE_TILE, fs->dst_w - tx);
+			const uint16_t *r = &fs->row[tx];
+			const uint8_t *rw = &fs->row_w[tx];
+
+			for (uint16_t y = ty; y < ty + th; y++) {
+				uint16_t *d = (uint16_t *)(dst + y * dst_pitch) + tx;
+				const uint16_t c0 = fs->col[y];
+				const uint8_t cw = fs->col_w[y];
+				const uint16_t c1 = c0 + (cw != 0);
+
+				if (fs->filter == FRAME_SCALE_NEAREST) {
+#define FRAME_SCALE_PX(i) FRAME_SCALE_SRC(c0, r[i])
+					FRAME_SCALE_SPAN(d, tw, FRAME_SCALE_PX);
+#undef FRAME_SCALE_PX
+					continue;
+				}
+
+#define FRAME_SCALE_PX(i) \
+	frame_scale_bilinear_px(src, src_pitch, c0, c1, cw, r[i], r[i] + (rw[i] != 0), rw[i])
+				FRAME_SCALE_SPAN(d, tw, FRAME_SCALE_PX);
+#undef FRAME_SCALE_PX
+			}
+		}
+	}
+}
+
+void frame_scale_rows(struct frame_scale *fs, const uint8_t *src, size_t src_pitch,
+		      uint8_t *dst, size_t dst_pitch, uint16_t row, uint16_t rows)
+{
+	const uint16_t end = MIN(row + rows, fs->dst_h);
+
+	if ((fs->orient & FRAME_SCALE_TRANSPOSE) != 0) {
+		frame_scale_rows_transposed(fs, src, src_pitch, dst, dst_pitch, row, end);
+		return;
+	}
+
+	/* The source may have changed since the last call */
+	fs->line_row = UINT16_MAX;
+
+	for (uint16_t y = row; y < end; y++) {
+		uint16_t *d = (uint16_t *)(dst + y * dst_pitch);
+
+		if (fs->filter == FRAME_SCALE_NEAREST) {
+			frame_scale_row_nearest(fs, (const uint16_t *)(src + fs->row[y] * src_pitch),
+						d);
+		} else {
+			frame_scale_fill_line(fs, src, src_pitch, fs->row[y], fs->row_w[y]);
+			frame_scale_row_bilinear(fs, d);
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * Fixed-point RGB565 frame scaler.
+ *
+ * Maps a src_w x src_h frame onto dst_w x dst_h pixels, nearest or
+ * bilinear, in any of the 8 orientations (rotation by 90/180/270 degrees
+ * and mirroring). Source column/row and weight of every destination
+ * column/row are computed once at init, so a frame costs table lookups,
+ * shifts and multiplies only, and mirroring is free: it only reverses a
+ * table. 90/270 degrees walk the source column-wise; the destination is
+ * then written in FRAME_SCALE_TILE square tiles, so each tile reads a
+ * small block of source rows instead of a whole column. Destination rows
+ * are written two pixels per 32-bit store. Pixels are big-endian RGB565
+ * (panel byte order).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_SCALE_H_
+#define FRAME_SCALE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest source or destination width/height */
+#define FRAME_SCALE_MAX_DIM  480
+
+/* Destination tile edge for the rotated (transposed) kernels */
+#define FRAME_SCALE_TILE     16
+
+/*
+ * Orientation flags, applied to the destination: transpose (destination
+ * columns follow source rows), then mirror left-right and/or top-bottom.
+ * Together they give the rotations below (clockwise).
+ */
+#define FRAME_SCALE_MIRROR_X    (1U << 0)
+#define FRAME_SCALE_MIRROR_Y    (1U << 1)
+#define FRAME_SCALE_TRANSPOSE   (1U << 2)
+
+#define FRAME_SCALE_ROTATE_0    0U
+#define FRAME_SCALE_ROTATE_90   (FRAME_SCALE_TRANSPOSE | FRAME_SCALE_MIRROR_X)
+#define FRAME_SCALE_ROTATE_180  (FRAME_SCALE_MIRROR_X | FRAME_SCALE_MIRROR_Y)
+#define FRAME_SCALE_ROTATE_270  (FRAME_SCALE_TRANSPOSE | FRAME_SCALE_MIRROR_Y)
+
+enum frame_scale_filter {
+	FRAME_SCALE_NEAREST,
+	/* 5-bit weights per axis, all three channels in one 32-bit multiply */
+	FRAME_SCALE_BILINEAR,
+};
+
+struct frame_scale {
+	uint16_t src_w;
+	uint16_t src_h;
+	uint16_t dst_w;
+	uint16_t dst_h;
+	enum frame_scale_filter filter;
+	/* FRAME_SCALE_MIRROR_* / FRAME_SCALE_TRANSPOSE */
+	uint8_t orient;
+	/*
+	 * Source column/row of each destination column/row (transposed: of
+	 * each destination row/column)...
+	 */
+	uint16_t col[FRAME_SCALE_MAX_DIM];
+	uint16_t row[FRAME_SCALE_MAX_DIM];
+	/* ...and the weight (0..31 of 32) of the next one */
+	uint8_t col_w[FRAME_SCALE_MAX_DIM];
+	uint8_t row_w[FRAME_SCALE_MAX_DIM];
+	/* Bilinear, not transposed: two source rows blended, as 0x07E0F81F-spread pixels */
+	uint32_t line[FRAME_SCALE_MAX_DIM + 1];
+	/* Source row and weight line[] holds, UINT16_MAX if none */
+	uint16_t line_row;
+	uint8_t line_w;
+};
+
+/**
+ * Build the column and row tables. Pixel centres are aligned, so the
+ * borders of src land on the borders of dst. dst_w x dst_h is the size
+ * after rotation (with FRAME_SCALE_TRANSPOSE, dst_w spans src_h).
+ *
+ * @param orient FRAME_SCALE_ROTATE_*, xor FRAME_SCALE_MIRROR_X for a mirror image
+ * @retval 0 on success, -EINVAL for a zero or too large size
+ */
+int frame_scale_init(struct frame_scale *fs, uint16_t src_w, uint16_t src_h, uint16_t dst_w,
+		     uint16_t dst_h, enum frame_scale_filter filter, uint8_t orient);
+
+/**
+ * Scale destination rows [row, row + rows) of a frame.
+ *
+ * @param fs        Scaler set up by frame_scale_init()
+ * @param src       Top-left source pixel
+ * @param src_pitch Source line length in bytes
+ * @param dst       Top-left destination pixel (row 0, not row)
+ * @param dst_pitch Destination line length in bytes
+ * @param row       First destination row
+ * @param rows      Number of destination rows
+ */
+void frame_scale_rows(struct frame_scale *fs, const uint8_t *src, size_t src_pitch,
+		      uint8_t *dst, size_t dst_pitch, uint16_t row, uint16_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_SCALE_H_ */
@@ -0,0 +1,237 @@
+/*
+ * Compressed frame streaming over a UART (see frame_stream.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame_stream.h"
+#include "frame_codec.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_REGISTER(frame_stream, LOG_LEVEL_INF);
+
+#define FRAME_STREAM_STACKSIZE  1024
+/* Below the camera pipeline: polled output keeps the CPU busy */
+#define FRAME_STREAM_PRIORITY   10
+
+static const uint8_t frame_stream_magic[4] = { 'K', 'K', 'F', 'S' };
+
+/* Header and payload, sent as one transfer */
+static uint8_t frame_stream_buf[CONFIG_APP_FRAME_STREAM_BUF_SIZE] __aligned(4);
+static size_t frame_stream_len;
+
+static K_SEM_DEFINE(frame_stream_started, 0, 1);
+static K_SEM_DEFINE(frame_stream_ready, 0, 1);
+/* Set from the frame taken until its packet is out */
+static atomic_t frame_stream_busy;
+
+/* Frame taken, read by the thread until the done callback */
+static const uint8_t *frame_stream_frame;
+static uint16_t frame_stream_w;
+static uint16_t frame_stream_h;
+static uint16_t frame_stream_pitch;
+static uint32_t frame_stream_frame_seq;
+
+static const struct device *frame_stream_uart;
+static frame_stream_done_cb_t frame_stream_done_cb;
+static void *frame_stream_user_data;
+static uint32_t frame_stream_decimation;
+static uint32_t frame_stream_skip;
+static uint32_t frame_stream_seq;
+
+static struct k_spinlock frame_stream_lock;
+static struct frame_stream_stats frame_stream_counters;
+
+#if defined(CONFIG_UART_ASYNC_API)
+static bool frame_stream_async;
+static K_SEM_DEFINE(frame_stream_tx_done, 0, 1);
+static int frame_stream_tx_ret;
+
+static void frame_stream_uart_cb(const struct device *dev, struct uart_event *evt,
+				 void *user_data)
+{
+	if (evt->type == UART_TX_DONE || evt->type == UART_TX_ABORTED) {
+		frame_stream_tx_ret = evt->type == UART_TX_DONE ? 0 : -EIO;
+		k_sem_give(&frame_stream_tx_done);
+	}
+}
+#endif
+
+int frame_stream_init(const struct device *uart, uint32_t decimation,
+		      frame_stream_done_cb_t cb, void *user_data)
+{
+	bool async = false;
+
+	if (decimation == 0) {
+		return -EINVAL;
+	}
+
+	if (frame_stream_uart != NULL) {
+		return -EALREADY;
+	}
+
+	if (!device_is_ready(uart)) {
+		return -ENODEV;
+	}
+
+#if defined(CONFIG_UART_ASYNC_API)
+	/* Drivers without the async API fall back to polled output */
+	frame_stream_async = uart_callback_set(uart, frame_stream_uart_cb, NULL) == 0;
+	async = frame_stream_async;
+#endif
+
+	frame_stream_done_cb = cb;
+	frame_stream_user_data = user_data;
+	frame_stream_uart = uart;
+	frame_stream_decimation = decimation;
+	frame_stream_skip = 0;
+
+	LOG_INF("Streaming 1/%u frames to %s (%s)", decimation, uart->name,
+		async ? "async" : "polled");
+
+	k_sem_give(&frame_stream_started);
+
+	return 0;
+}
+
+bool frame_stream_submit(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch)
+{
+	k_spinlock_key_t key;
+
+	if (frame_stream_uart == NULL || ++frame_stream_skip < frame_stream_decimation) {
+		return false;
+	}
+	frame_stream_skip = 0;
+	frame_stream_seq++;
+
+	if (!atomic_cas(&frame_stream_busy, 0, 1)) {
+		key = k_spin_lock(&frame_stream_lock);
+		frame_stream_counters.busy++;
+		k_spin_unlock(&frame_stream_lock, key);
+		return false;
+	}
+
+	frame_stream_frame = buf;
+	frame_stream_w = w;
+	frame_stream_h = h;
+	frame_stream_pitch = pitch;
+	frame_stream_frame_seq = frame_stream_seq;
+	k_sem_give(&frame_stream_ready);
+
+	return true;
+}
+
+/* Encode the frame taken into a packet and hand the frame back; <0 if too big */
+static int frame_stream_encode(void)
+{
+	uint8_t *payload = &frame_stream_buf[FRAME_STREAM_HEADER_SIZE];
+	const size_t space = sizeof(frame_stream_buf) - FRAME_STREAM_HEADER_SIZE;
+	const uint16_t w = frame_stream_w;
+	const uint16_t h = frame_stream_h;
+	enum frame_codec codec;
+	k_spinlock_key_t key;
+	int len;
+
+	len = frame_codec_encode(frame_stream_frame, w, h, frame_stream_pitch, payload, space,
+				 &codec);
+	if (frame_stream_done_cb != NULL) {
+		frame_stream_done_cb(frame_stream_frame, frame_stream_user_data);
+	}
+
+	if (len < 0) {
+		key = k_spin_lock(&frame_stream_lock);
+		frame_stream_counters.too_big++;
+		k_spin_unlock(&frame_stream_lock, key);
+		return len;
+	}
+
+	memcpy(frame_stream_buf, frame_stream_magic, sizeof(frame_stream_magic));
+	frame_stream_buf[4] = FRAME_STREAM_VERSION;
+	frame_stream_buf[5] = codec;
+	sys_put_le16(w, &frame_stream_buf[6]);
+	sys_put_le16(h, &frame_stream_buf[8]);
+	sys_put_le32(frame_stream_frame_seq, &frame_stream_buf[10]);
+	sys_put_le32(len, &frame_stream_buf[14]);
+	sys_put_le32(crc32_ieee(payload, len), &frame_stream_buf[18]);
+	frame_stream_len = FRAME_STREAM_HEADER_SIZE + len;
+
+	key = k_spin_lock(&frame_stream_lock);
+	frame_stream_counters.payload_bytes += len;
+	frame_stream_counters.raw_bytes += (uint32_t)w * h * sizeof(uint16_t);
+	k_spin_unlock(&frame_stream_lock, key);
+
+	return len;
+}
+
+void frame_stream_get_stats(struct frame_stream_stats *stats, bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&frame_stream_lock);
+
+	*stats = frame_stream_counters;
+	if (reset) {
+		memset(&frame_stream_counters, 0, sizeof(frame_stream_counters));
+	}
+
+	k_spin_unlock(&frame_stream_lock, key);
+}
+
+static int frame_stream_send(const uint8_t *buf, size_t len)
+{
+#if defined(CONFIG_UART_ASYNC_API)
+	if (frame_stream_async) {
+		int ret = uart_tx(frame_stream_uart, buf, len, SYS_FOREVER_US);
+
+		if (ret < 0) {
+			return ret;
+		}
+		k_sem_take(&frame_stream_tx_done, K_FOREVER);
+
+		return frame_stream_tx_ret;
+	}
+#endif
+
+	for (size_t i = 0; i < len; i++) {
+		uart_poll_out(frame_stream_uart, buf[i]);
+	}
+
+	return 0;
+}
+
+/* Encode and send the frames taken; the DMA transfer (or polled output) sets the rate */
+static void frame_stream_thread(void)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	k_sem_take(&frame_stream_started, K_FOREVER);
+
+	while (1) {
+		k_sem_take(&frame_stream_ready, K_FOREVER);
+
+		if (frame_stream_encode() < 0) {
+			atomic_clear(&frame_stream_busy);
+			continue;
+		}
+
+		ret = frame_stream_send(frame_stream_buf, frame_stream_len);
+		if (ret < 0) {
+			LOG_ERR("Frame stream send failed: %d", ret);
+		} else {
+			key = k_spin_lock(&frame_stream_lock);
+			frame_stream_counters.sent++;
+			k_spin_unlock(&frame_stream_lock, key);
+		}
+
+		atomic_clear(&frame_stream_busy);
+	}
+}
+
+K_THREAD_DEFINE(frame_stream_id, FRAME_STREAM_STACKSIZE, frame_stream_thread, NULL, NULL, NULL,
+		FRAME_STREAM_PRIORITY, 0, 0);
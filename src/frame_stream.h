@@ -0,0 +1,84 @@
+/*
+ * Compressed frame streaming over a UART.
+ *
+ * Every Nth composed frame is taken by a low-priority thread, encoded
+ * (frame_codec.h) into a packet buffer and sent, with the UART async (DMA)
+ * API when the driver has it and uart_poll_out() otherwise (e.g. the
+ * native_sim pty). The caller keeps a frame taken unchanged until the done
+ * callback, which comes right after the encode, before the send. A frame
+ * that arrives while the previous packet is still being encoded or sent is
+ * skipped: the UART sets the stream rate.
+ *
+ * Packet (little-endian):
+ *   magic "KKFS" | version u8 | codec u8 | width u16 | height u16 |
+ *   sequence u32 | payload length u32 | CRC-32 (IEEE) of payload u32 | payload
+ *
+ * The payload is a frame_codec.h frame; scripts/frame_stream_rx.py is the
+ * matching receiver.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_STREAM_H_
+#define FRAME_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_STREAM_VERSION     1
+#define FRAME_STREAM_HEADER_SIZE 22
+
+/* Counters since init or the last reset */
+struct frame_stream_stats {
+	/* Packets sent */
+	uint32_t sent;
+	/* Frames skipped because the previous packet was still being sent */
+	uint32_t busy;
+	/* Frames skipped because they did not fit in the packet buffer */
+	uint32_t too_big;
+	/* Payload and raw bytes of the packets sent */
+	uint32_t payload_bytes;
+	uint32_t raw_bytes;
+};
+
+/* Called from the stream thread once it no longer reads a frame it took */
+typedef void (*frame_stream_done_cb_t)(const uint8_t *buf, void *user_data);
+
+/**
+ * Start streaming to uart. Call once.
+ *
+ * @param uart       UART to send on
+ * @param decimation Send one frame out of decimation (at least 1)
+ * @param cb         Frame done callback (may be NULL)
+ * @param user_data  Passed to cb
+ * @retval 0 on success, -EINVAL for a zero decimation, -ENODEV if the UART
+ *         is not ready, -EALREADY if started
+ */
+int frame_stream_init(const struct device *uart, uint32_t decimation,
+		      frame_stream_done_cb_t cb, void *user_data);
+
+/**
+ * Offer a composed frame (big-endian RGB565). Only takes it: the stream
+ * thread encodes it later.
+ *
+ * @param buf   Top-left pixel
+ * @param w     Width in pixels
+ * @param h     Height in pixels
+ * @param pitch Line length in pixels
+ * @retval true if taken: buf must stay unchanged until the done callback
+ */
+bool frame_stream_submit(const uint8_t *buf, uint16_t w, uint16_t h, uint16_t pitch);
+
+/** Read (and optionally clear) the stream counters. */
+void frame_stream_get_stats(struct frame_stream_stats *stats, bool reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_STREAM_H_ */
@@ -0,0 +1,107 @@
+/*
+ * Fixed-bucket latency histograms (see latency_hist.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "latency_hist.h"
+
+#include <string.h>
+
+/* Sub-buckets per power of two: 2^LATENCY_HIST_SUB_BITS */
+#define LATENCY_HIST_SUB_BITS 2
+#define LATENCY_HIST_SUB      BIT(LATENCY_HIST_SUB_BITS)
+
+static size_t latency_hist_index(uint32_t cycles)
+{
+	uint32_t msb;
+
+	if (cycles < LATENCY_HIST_SUB) {
+		return cycles;
+	}
+
+	msb = find_msb_set(cycles) - 1;
+
+	return LATENCY_HIST_SUB + (msb - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB +
+	       ((cycles >> (msb - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB - 1));
+}
+
+uint32_t latency_hist_bucket_floor(size_t idx)
+{
+	uint32_t msb;
+	uint32_t sub;
+
+	if (idx < LATENCY_HIST_SUB) {
+		return idx;
+	}
+
+	msb = (idx - LATENCY_HIST_SUB) / LATENCY_HIST_SUB + LATENCY_HIST_SUB_BITS;
+	sub = (idx - LATENCY_HIST_SUB) % LATENCY_HIST_SUB;
+
+	return (LATENCY_HIST_SUB + sub) << (msb - LATENCY_HIST_SUB_BITS);
+}
+
+void latency_hist_record(struct latency_hist *h, uint32_t cycles)
+{
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	if (h->count == 0 || cycles < h->min) {
+		h->min = cycles;
+	}
+	if (cycles > h->max) {
+		h->max = cycles;
+	}
+	h->count++;
+	h->sum += cycles;
+	h->buckets[latency_hist_index(cycles)]++;
+
+	k_spin_unlock(&h->lock, key);
+}
+
+void latency_hist_summarize(struct latency_hist *h, struct latency_hist_summary *s, bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+	uint32_t p99 = 0;
+
+	memset(s, 0, sizeof(*s));
+
+	if (h->count > 0) {
+		/* Smallest bucket with at least 99% of the samples at or below it */
+		uint32_t rank = h->count - h->count / 100;
+		uint32_t seen = 0;
+
+		for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+			seen += h->buckets[i];
+			if (seen >= rank) {
+				p99 = i + 1 < LATENCY_HIST_BUCKETS ?
+				      latency_hist_bucket_floor(i + 1) - 1 : UINT32_MAX;
+				break;
+			}
+		}
+
+		s->count = h->count;
+		s->min_us = k_cyc_to_us_floor32(h->min);
+		s->avg_us = k_cyc_to_us_floor32(h->sum / h->count);
+		s->p99_us = k_cyc_to_us_ceil32(MIN(p99, h->max));
+		s->max_us = k_cyc_to_us_ceil32(h->max);
+	}
+
+	if (reset) {
+		h->count = 0;
+		h->min = 0;
+		h->max = 0;
+		h->sum = 0;
+		memset(h->buckets, 0, sizeof(h->buckets));
+	}
+
+	k_spin_unlock(&h->lock, key);
+}
+
+void latency_hist_buckets(struct latency_hist *h, uint32_t buckets[LATENCY_HIST_BUCKETS])
+{
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	memcpy(buckets, h->buckets, sizeof(h->buckets));
+
+	k_spin_unlock(&h->lock, key);
+}
@@ -0,0 +1,70 @@
+/*
+ * Fixed-bucket latency histograms.
+ *
+ * Samples are k_cycle_get_32() deltas. Buckets are exact below 4 cycles,
+ * then 4 per power of two (at most 25% wide), which covers the full 32-bit
+ * range in LATENCY_HIST_BUCKETS counters. Summaries are in microseconds.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LATENCY_HIST_H_
+#define LATENCY_HIST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_HIST_BUCKETS 124
+
+struct latency_hist {
+	struct k_spinlock lock;
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t buckets[LATENCY_HIST_BUCKETS];
+};
+
+struct latency_hist_summary {
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t avg_us;
+	/* Upper edge of the bucket holding the 99th percentile */
+	uint32_t p99_us;
+	uint32_t max_us;
+};
+
+/* Add one sample, in cycles (any context). */
+void latency_hist_record(struct latency_hist *h, uint32_t cycles);
+
+/**
+ * Summarize the samples so far, and optionally start over.
+ *
+ * @param h     Histogram
+ * @param s     Filled with the summary (all zero without samples)
+ * @param reset Clear the histogram after reading
+ */
+void latency_hist_summarize(struct latency_hist *h, struct latency_hist_summary *s, bool reset);
+
+/**
+ * Copy the bucket counts, for a detailed dump.
+ *
+ * @param h       Histogram
+ * @param buckets Filled with LATENCY_HIST_BUCKETS counts
+ */
+void latency_hist_buckets(struct latency_hist *h, uint32_t buckets[LATENCY_HIST_BUCKETS]);
+
+/* Lowest sample, in cycles, that lands in bucket idx. */
+uint32_t latency_hist_bucket_floor(size_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HIST_H_ */
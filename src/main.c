@@ -11,15 +11,25 @@
 LOG_MODULE_REGISTER(kk_edge_ai, LOG_LEVEL_INF);
 
 #include "main_functions.h"  /* TFLM: overlay get/ready (draw); setup/fill (inference thread) */
+#include "display_async.h"   /* display_write() off the compose path, two output buffers */
+#include "tile_diff.h"       /* send only the camera tiles that changed */
+#include "frame_pacer.h"     /* frame interval follows the pipeline load */
+#include "latency_hist.h"    /* per-stage timing of the pipeline */
+#include "frame_scale.h"     /* camera frame scaled to the panel */
+#include "frame_stream.h"    /* composed frames, compressed, out on a UART */
+#include "frame_record.h"    /* composed frames, compressed, kept in flash */
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/display.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/video.h>
 #include <zephyr/drivers/video-controls.h>
+#include <zephyr/drivers/video/stm32u5_dcmi.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/flash_map.h>
 #include <version.h>
 #include <math.h>
 #include <stdlib.h>
@@ -29,6 +39,7 @@ LOG_MODULE_REGISTER(kk_edge_ai, LOG_LEVEL_INF);
 #define DEFAULT_STACKSIZE    1024
 #define INFERENCE_STACKSIZE  2048
 #define CAMERA_STACKSIZE     4096
+#define COMPOSE_STACKSIZE    2048
 
 /* scheduling priority: lower number = higher priority in Zephyr */
 #define EQUAL_PRIORITY    7
@@ -55,36 +66,239 @@ LOG_MODULE_REGISTER(kk_edge_ai, LOG_LEVEL_INF);
 /* Configure button (sw0) as capture trigger */
 const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(SW0_NODE, gpios);
 
-/* CAMERA: sensor for readiness check, DCMI controller for all video API ops */
+/*
+ * CAMERA: sensor for readiness check, DCMI controller for all video API ops.
+ * Under native_sim the DCMI is emulated (st,stm32u5-dcmi-emul) and there is
+ * no OV5640: sensor setup is skipped and capture starts without SW0.
+ */
+#define CAMERA_HAS_OV5640 DT_NODE_HAS_STATUS_OKAY(DT_NODELABEL(ov5640))
+
+#if CAMERA_HAS_OV5640
 const struct device *ov5640 = DEVICE_DT_GET(DT_NODELABEL(ov5640));
+#endif
 const struct device *video_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_camera));
 
 /*
- * STM32U5 GPDMA block-transfer limit is 65 535 bytes (16-bit BNDT register).
- * 320x240 RGB565 = 153 600 bytes — exceeds the limit, HAL rejects the DMA.
- * 160x120 RGB565 =  38 400 bytes — fits comfortably.
+ * STM32U5 GPDMA block-transfer limit is 65 535 bytes (16-bit BNDT register);
+ * the DCMI driver chains several blocks through a linked-list queue, so e.g.
+ * 320x240 RGB565 (153 600 bytes) works given CONFIG_VIDEO_BUFFER_POOL_SZ_MAX.
+ * 160x120 RGB565 = 38 400 bytes is the boot format, centred on the 240x135
+ * panel; camera_reconfigure() changes it at run time.
  */
 #define CAMERA_W          160
 #define CAMERA_H          120
 #define DISPLAY_W         240
 #define DISPLAY_H         135
-#define FRAME_X_OFFSET    ((DISPLAY_W - CAMERA_W) / 2)   /* center 160 on 240 */
-#define FRAME_Y_OFFSET    ((DISPLAY_H - CAMERA_H) / 2)   /* center 120 on 135 */
+
+/* OV5640 mirror/flip, rewritten after every format change */
+#define CAMERA_HFLIP      0
+#define CAMERA_VFLIP      0
 
 #define STANDBY_TEXT_MAX_LEN 24
 
 /*
- * Capture mode: 0 = SNAPSHOT, 1 = CONTINUOUS.
- * Note: The DCMI driver captures one frame per video_stream_start; it does not
- * produce a continuous stream. Both modes use start/stop per frame.
+ * Capture mode follows the DCMI driver (CONFIG_VIDEO_STM32U5_DCMI_CAPTURE_MODE):
+ * SNAPSHOT captures one frame per video_stream_start, so the loop starts and
+ * stops the stream around every frame. CONTINUOUS starts the stream once and
+ * the driver re-arms the DMA from the enqueued buffers at every frame end.
+ */
+#define CAMERA_CAPTURE_MODE_CONTINUOUS  IS_ENABLED(CONFIG_VIDEO_STM32U5_DCMI_CONTINUOUS)
+
+/*
+ * Band mode (continuous capture only): the DCMI driver reports every
+ * CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES lines as they land, and each band is
+ * copied, overlaid and sent to the panel while the rest of the frame arrives.
+ */
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES)
+#define CAMERA_BAND_LINES  CONFIG_VIDEO_STM32U5_DCMI_BAND_LINES
+#else
+#define CAMERA_BAND_LINES  0
+#endif
+#define CAMERA_BAND_MODE   (CAMERA_BAND_LINES > 0 && CAMERA_CAPTURE_MODE_CONTINUOUS)
+
+/*
+ * Frame pipeline (all modes but band mode): capture (camera_thread) ->
+ * compose (copy + overlay) -> panel (display_async thread, display_write).
+ * Each stage owns a buffer while working on it and passes it on through a
+ * message queue, so frame N+1 is captured while frame N is composed and
+ * frame N-1 is sent to the panel: the frame rate follows the slowest stage,
+ * not the sum of all. Band mode streams bands straight to the panel and
+ * uses one display buffer.
+ */
+#define CAMERA_DISP_BUFS   (CAMERA_BAND_MODE ? 1 : DISPLAY_ASYNC_MAX_BUFS)
+
+/*
+ * Zero-copy (CONFIG_APP_CAMERA_ZERO_COPY, not in band mode): the overlay is
+ * drawn into the captured frame, which goes to the panel as is at
+ * frame_x/frame_y. No display buffers; borders are written once per format.
+ */
+#define CAMERA_ZERO_COPY   (IS_ENABLED(CONFIG_APP_CAMERA_ZERO_COPY) && !CAMERA_BAND_MODE)
+
+/* Rotation and mirroring of the camera image on the panel (CONFIG_APP_CAMERA_ROTATE_*) */
+#define CAMERA_ORIENT      ((IS_ENABLED(CONFIG_APP_CAMERA_ROTATE_90) ? FRAME_SCALE_ROTATE_90 :   \
+			     IS_ENABLED(CONFIG_APP_CAMERA_ROTATE_180) ? FRAME_SCALE_ROTATE_180 : \
+			     IS_ENABLED(CONFIG_APP_CAMERA_ROTATE_270) ? FRAME_SCALE_ROTATE_270 : \
+			     FRAME_SCALE_ROTATE_0) ^                                             \
+			    (IS_ENABLED(CONFIG_APP_CAMERA_MIRROR) ? FRAME_SCALE_MIRROR_X : 0))
+
+/*
+ * Scaling (CONFIG_APP_CAMERA_SCALE_FIT/_FILL) and orientation are part of
+ * the compose copy, so zero-copy and band mode always show the frame 1:1.
+ */
+#define CAMERA_SCALING     ((!IS_ENABLED(CONFIG_APP_CAMERA_SCALE_NONE) || CAMERA_ORIENT != 0) && \
+			    !CAMERA_ZERO_COPY && !CAMERA_BAND_MODE)
+
+/* Frame pacing (CONFIG_APP_FRAME_PACER) needs the compose/panel stages */
+#define CAMERA_PACING      (IS_ENABLED(CONFIG_APP_FRAME_PACER) && !CAMERA_BAND_MODE)
+
+/*
+ * Frame streaming (CONFIG_APP_FRAME_STREAM) taps the panel stage: every
+ * frame is offered once the panel has it, on the UART chosen as
+ * app,frame-stream.
+ */
+#define CAMERA_STREAM      (IS_ENABLED(CONFIG_APP_FRAME_STREAM) && !CAMERA_BAND_MODE)
+
+#if IS_ENABLED(CONFIG_APP_FRAME_STREAM) && !DT_HAS_CHOSEN(app_frame_stream)
+#error "CONFIG_APP_FRAME_STREAM: no app,frame-stream UART chosen in devicetree"
+#endif
+
+/* Frame recording (CONFIG_APP_FRAME_RECORD) taps the same point, to flash */
+#define CAMERA_RECORD      (IS_ENABLED(CONFIG_APP_FRAME_RECORD) && !CAMERA_BAND_MODE)
+
+#if IS_ENABLED(CONFIG_APP_FRAME_RECORD) && !FIXED_PARTITION_EXISTS(frame_record_partition)
+#error "CONFIG_APP_FRAME_RECORD: no frame_record_partition in devicetree"
+#endif
+
+/*
+ * Active capture format, and the centred area of the panel it is shown in
+ * (set by camera_layout()). Only camera_reconfigure() changes them, with
+ * the stream stopped and the compose stage idle.
  */
-#define CAMERA_CAPTURE_MODE_CONTINUOUS  0  // TBD: need implement REAL continuous mode
+static struct video_format camera_fmt = {
+	.type = VIDEO_BUF_TYPE_OUTPUT,
+	.pixelformat = VIDEO_PIX_FMT_RGB565,
+	.width = CAMERA_W,
+	.height = CAMERA_H,
+	.pitch = CAMERA_W * sizeof(uint16_t),
+};
+static uint16_t frame_x;
+static uint16_t frame_y;
+static uint16_t frame_w;
+static uint16_t frame_h;
+
+#if CAMERA_SCALING
+static struct frame_scale camera_scale;
+#endif
 
 static atomic_t show_camera_frame = ATOMIC_INIT(0);
 static K_SEM_DEFINE(capture_sem, 0, 1);
+static K_SEM_DEFINE(inference_done_sem, 0, 1);
+
+/* Raised by the DCMI driver for every frame handed out (or on capture error) */
+static struct k_poll_signal camera_signal = K_POLL_SIGNAL_INITIALIZER(camera_signal);
+
+#if !CAMERA_BAND_MODE
+/* A captured frame on its way to compose, with its timestamps (cycles) */
+struct camera_frame {
+	struct video_buffer *vbuf;
+	/* VSYNC that started the frame */
+	uint32_t vsync_cycles;
+	/* Dequeued by camera_thread */
+	uint32_t dequeue_cycles;
+};
+
+/*
+ * Captured frames waiting for compose. Depth 1: when compose falls behind,
+ * camera_thread blocks instead of taking every buffer away from the driver.
+ * A frame without vbuf asks compose to drain: it gives compose_idle_sem
+ * once the panel has everything submitted so far, and starts over (full
+ * frame, new geometry) with the next frame.
+ */
+K_MSGQ_DEFINE(compose_msgq, sizeof(struct camera_frame), 1, 4);
+static K_SEM_DEFINE(compose_idle_sem, 0, 1);
+/* Camera frame submitted to the panel: its buffer and VSYNC stamp */
+struct camera_glass {
+	const uint8_t *buf;
+	uint32_t vsync_cycles;
+};
+
+/* Camera frames submitted to the panel, in display order */
+K_MSGQ_DEFINE(glass_msgq, sizeof(struct camera_glass), DISPLAY_ASYNC_MAX_BUFS, 4);
+
+#if CAMERA_STREAM || CAMERA_RECORD
+/*
+ * One frame at a time is lent to the frame sinks, straight from the panel
+ * stage; it goes back to the pipeline once every sink that took it has
+ * encoded it. Given while no frame is lent.
+ */
+static K_SEM_DEFINE(camera_tap_idle_sem, 1, 1);
+#endif
+
+/*
+ * Pipeline stages timed into latency histograms, dumped on SW0 presses
+ * once capture runs (or with the "latency" shell command).
+ */
+enum camera_stage {
+	CAMERA_STAGE_CAPTURE,	/* VSYNC (blanking before the frame) -> dequeued */
+	CAMERA_STAGE_QUEUE,	/* dequeued -> compose starts (incl. display buffer wait) */
+	CAMERA_STAGE_COPY,	/* frame copy (and scaling) into the display buffer */
+	CAMERA_STAGE_OVERLAY,	/* sine overlay */
+	CAMERA_STAGE_DIFF,	/* tile hashing and merge */
+	CAMERA_STAGE_ENQUEUE,	/* video_enqueue() */
+	CAMERA_STAGE_DISPLAY,	/* display_write() of the changed tiles */
+	CAMERA_STAGE_GLASS,	/* VSYNC (blanking before the frame) -> on the panel */
+	CAMERA_STAGES,
+};
+
+static const char *const camera_stage_names[CAMERA_STAGES] = {
+	"capture", "queue", "copy", "overlay", "diff", "enqueue", "display", "glass",
+};
+
+static struct latency_hist camera_latency[CAMERA_STAGES];
+
+/* Panel bytes sent vs. full-frame bytes since the last FPS log */
+static atomic_t disp_bytes_sent;
+static atomic_t disp_bytes_full;
+
+#if CAMERA_BAND_MODE
+/* Bands lost because camera_band_msgq was full, since the last FPS log */
+static atomic_t camera_band_drops;
+#endif
+
+#if CAMERA_ZERO_COPY
+/*
+ * Frame on its way to the panel. One at a time, so that compose and the
+ * panel never hold more than two video buffers between them.
+ */
+static struct video_buffer *panel_vbuf;
+static K_SEM_DEFINE(panel_idle_sem, 1, 1);
+#endif
+#endif
+
+/* camera_thread k_poll() events */
+enum {
+	CAMERA_EVT_FRAME,
+	CAMERA_EVT_BUTTON,
+	CAMERA_EVT_INFERENCE,
+	CAMERA_EVT_RECONFIG,
+};
+
+/* Capture format change asked for ("camera" shell command), applied by camera_thread */
+struct camera_reconfig_req {
+	uint16_t width;
+	uint16_t height;
+	uint32_t pixelformat;
+};
+
+K_MSGQ_DEFINE(camera_reconfig_msgq, sizeof(struct camera_reconfig_req), 1, 4);
+#if !CAMERA_BAND_MODE
+/* Outcome of the last request, for the shell: 0 applied, or why not */
+static K_SEM_DEFINE(camera_reconfig_done, 0, 1);
+static int camera_reconfig_ret;
+#endif
 
-/* FPS measurement */
-static uint32_t frame_count;
+/* FPS measurement: frames counted by the panel stage, logged by camera_thread */
+static atomic_t frame_count;
 static int64_t fps_start_ms;
 static float fps_current;
 static float fps_last_logged = -1.0f;
@@ -438,13 +652,30 @@ static void button_pressed_cb(const struct device *dev,
 
 /* ---- Camera ---------------------------------------------------- */
 /*
- * Set one pixel in the display buffer (RGB565, DISPLAY_W x DISPLAY_H).
+ * RGB565 buffer the overlay is drawn into, covering display area
+ * [x, x + w) x [y, y + h) with a pitch of w pixels: a whole display buffer,
+ * or in zero-copy mode the captured frame itself. Drawing always uses
+ * display coordinates.
+ */
+struct draw_target {
+	uint8_t *buf;
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+};
+
+#define DRAW_TARGET_DISPLAY(dst) \
+	((struct draw_target){ .buf = (dst), .w = DISPLAY_W, .h = DISPLAY_H })
+
+/*
+ * Set one pixel in the draw target (RGB565).
  * (dx, dy) are display coordinates; color is 0x00RRGGBB.
  */
-static void set_display_pixel_rgb565(uint8_t *dst, uint16_t dx, uint16_t dy,
+static void set_display_pixel_rgb565(const struct draw_target *t, uint16_t dx, uint16_t dy,
                                      uint32_t color)
 {
-    if (dx >= DISPLAY_W || dy >= DISPLAY_H) {
+    if (dx < t->x || dx >= t->x + t->w || dy < t->y || dy >= t->y + t->h) {
         return;
     }
 
@@ -454,18 +685,19 @@ static void set_display_pixel_rgb565(uint8_t *dst, uint16_t dx, uint16_t dy,
     uint16_t c565 = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
 
     /* Write as [high byte][low byte] to match display expectations */
-    uint32_t pixel_index = (uint32_t)dy * DISPLAY_W + dx;
+    uint32_t pixel_index = (uint32_t)(dy - t->y) * t->w + (dx - t->x);
     uint32_t byte_index  = pixel_index * 2U;
 
-    dst[byte_index]     = (uint8_t)((c565 >> 8) & 0xFF);
-    dst[byte_index + 1] = (uint8_t)(c565 & 0xFF);
+    t->buf[byte_index]     = (uint8_t)((c565 >> 8) & 0xFF);
+    t->buf[byte_index + 1] = (uint8_t)(c565 & 0xFF);
 }
 
 /*
- * Draw a line segment in the display buffer (RGB565) using Bresenham.
+ * Draw a line segment in the draw target (RGB565) using Bresenham.
+ * Only pixels on display rows [y_min, y_max] are written.
  */
-static void draw_line_rgb565(uint8_t *dst, int x0, int y0, int x1, int y1,
-			     uint32_t color)
+static void draw_line_rgb565(const struct draw_target *dst, int x0, int y0, int x1, int y1,
+			     uint32_t color, int y_min, int y_max)
 {
 	int dx = x1 - x0;
 	int dy = y1 - y0;
@@ -473,25 +705,32 @@ static void draw_line_rgb565(uint8_t *dst, int x0, int y0, int x1, int y1,
 	int ay = (dy < 0) ? -dy : dy;
 	int steps = (ax > ay) ? ax : ay;
 	if (steps <= 0) {
-		set_display_pixel_rgb565(dst, (uint16_t)x0, (uint16_t)y0, color);
+		if (y0 >= y_min && y0 <= y_max) {
+			set_display_pixel_rgb565(dst, (uint16_t)x0, (uint16_t)y0, color);
+		}
 		return;
 	}
 	for (int i = 0; i <= steps; i++) {
 		int t = (steps == 0) ? 0 : (i * 65536 / steps);
 		int x = x0 + (dx * t) / 65536;
 		int y = y0 + (dy * t) / 65536;
-		set_display_pixel_rgb565(dst, (uint16_t)x, (uint16_t)y, color);
+		if (y >= y_min && y <= y_max) {
+			set_display_pixel_rgb565(dst, (uint16_t)x, (uint16_t)y, color);
+		}
 	}
 }
 
 /*
  * Draw sine overlay from precomputed buffer (filled by inference thread).
  * No TFLM inference in this thread; read-only for person-detection-ready design.
+ * Drawing is clipped to display rows [y_min, y_max] so it can run per band.
  */
-static void draw_sine_overlay(uint8_t *dst)
+static void draw_sine_overlay(const struct draw_target *dst, int y_min, int y_max)
 {
-	const int center_y = FRAME_Y_OFFSET + CAMERA_H / 2;
-	const int amplitude = (CAMERA_H / 2) - 4;
+	const int cam_w = frame_w;
+	const int cam_h = frame_h;
+	const int center_y = frame_y + cam_h / 2;
+	const int amplitude = (cam_h / 2) - 4;
 	if (amplitude <= 0) {
 		return;
 	}
@@ -510,266 +749,1520 @@ static void draw_sine_overlay(uint8_t *dst)
 	int prev_py = -1;
 	for (int i = 0; i < num_points; i++) {
 		float y = y_values[i];
-		int px = FRAME_X_OFFSET + (int)((float)i * (float)(CAMERA_W - 1) /
-						(float)(num_points > 1 ? num_points - 1 : 1));
-		if (px >= FRAME_X_OFFSET + (int)CAMERA_W) {
-			px = FRAME_X_OFFSET + CAMERA_W - 1;
+		int px = frame_x + (int)((float)i * (float)(cam_w - 1) /
+					 (float)(num_points > 1 ? num_points - 1 : 1));
+		if (px >= frame_x + cam_w) {
+			px = frame_x + cam_w - 1;
 		}
 		int py = center_y - (int)(y * (float)amplitude);
 
-		if (py < (int)FRAME_Y_OFFSET) {
-			py = FRAME_Y_OFFSET;
+		if (py < (int)frame_y) {
+			py = frame_y;
 		}
-		if (py >= FRAME_Y_OFFSET + (int)CAMERA_H) {
-			py = FRAME_Y_OFFSET + CAMERA_H - 1;
+		if (py >= frame_y + cam_h) {
+			py = frame_y + cam_h - 1;
 		}
 
-		set_display_pixel_rgb565(dst, (uint16_t)px, (uint16_t)py, COLOR_GREEN);
+		if (py >= y_min && py <= y_max) {
+			set_display_pixel_rgb565(dst, (uint16_t)px, (uint16_t)py, COLOR_GREEN);
+		}
 		if (prev_px >= 0) {
-			draw_line_rgb565(dst, prev_px, prev_py, px, py, COLOR_GREEN);
+			draw_line_rgb565(dst, prev_px, prev_py, px, py, COLOR_GREEN,
+					 y_min, y_max);
 		}
 		prev_px = px;
 		prev_py = py;
 	}
 }
 
-/**
- * Copy 160x120 frame 1:1 (no scaling), centred on 240x135 display.
- * Black borders fill the margins.
- * Then draw the Zephyr hello_world-style sine wave overlay on the frame.
+/*
+ * One YUYV (YUV 4:2:2) row to big-endian RGB565, the panel byte order.
+ * BT.601 limited range, 8-bit fixed point; width must be even. Works in
+ * place (src == dst).
+ */
+static void yuyv_row_to_rgb565(const uint8_t *src, uint8_t *dst, uint16_t width)
+{
+	for (uint16_t x = 0; x < width; x += 2, src += 4) {
+		const int d = src[1] - 128;
+		const int e = src[3] - 128;
+		const int r = 409 * e + 128;
+		const int g = -100 * d - 208 * e + 128;
+		const int b = 516 * d + 128;
+
+		for (int i = 0; i < 2; i++) {
+			const int c = 298 * (src[2 * i] - 16);
+			const uint16_t c565 = ((CLAMP((c + r) >> 8, 0, 255) >> 3) << 11) |
+					      ((CLAMP((c + g) >> 8, 0, 255) >> 2) << 5) |
+					       (CLAMP((c + b) >> 8, 0, 255) >> 3);
+
+			*dst++ = c565 >> 8;
+			*dst++ = c565 & 0xFF;
+		}
+	}
+}
+
+/*
+ * Copy camera lines [line, line + lines) 1:1 into their centred display
+ * rows, converting YUYV to RGB565 on the way.
  */
-static void copy_frame_to_display(const uint8_t *src, uint8_t *dst)
+static void copy_rows_to_display(const uint8_t *src, uint8_t *dst, int line, int lines)
 {
-	/* One-time clear of borders; camera region is fully overwritten each frame. */
-	static int borders_cleared;
+	const size_t row_bytes = camera_fmt.width * sizeof(uint16_t);
 
-	const uint16_t *s = (const uint16_t *)src;
-	uint16_t *d = (uint16_t *)dst;
+	for (int y = line; y < line + lines; y++) {
+		const uint8_t *src_row = src + y * camera_fmt.pitch;
+		uint8_t *dst_row = dst + ((frame_y + y) * DISPLAY_W + frame_x) * sizeof(uint16_t);
 
-	if (!borders_cleared) {
-		memset(dst, 0x00, DISPLAY_W * DISPLAY_H * sizeof(uint16_t));
-		borders_cleared = 1;
+		if (camera_fmt.pixelformat == VIDEO_PIX_FMT_YUYV) {
+			yuyv_row_to_rgb565(src_row, dst_row, camera_fmt.width);
+		} else {
+			memcpy(dst_row, src_row, row_bytes);
+		}
 	}
+}
 
-	for (int y = 0; y < CAMERA_H; y++) {
-		const uint16_t *src_row = s + y * CAMERA_W;
-		uint16_t *dst_row = d + (FRAME_Y_OFFSET + y) * DISPLAY_W + FRAME_X_OFFSET;
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS)
+/* Log DCMI/GPDMA ISR cost (cycles) accumulated since the previous call. */
+static void log_dcmi_isr_stats(void)
+{
+	static const char *const names[] = { "DCMI", "DMA" };
+	struct video_stm32u5_dcmi_isr_stats st;
 
-		memcpy(dst_row, src_row, CAMERA_W * sizeof(uint16_t));
+	for (int i = 0; i < ARRAY_SIZE(names); i++) {
+		if (video_stm32u5_dcmi_get_isr_stats(video_dev, i, &st, true) != 0 ||
+		    st.count == 0) {
+			continue;
+		}
+		LOG_INF("%s ISR: n=%u avg=%u max=%u cycles", names[i], st.count,
+			(uint32_t)(st.total_cycles / st.count), st.max_cycles);
 	}
-
-	draw_sine_overlay(dst);
 }
+#endif
 
-void camera_thread(void)
+/* Log DCMI drops/errors accumulated since the previous call, if any. */
+static void log_dcmi_stats(void)
 {
-	int ret;
+	struct video_stm32u5_dcmi_stats st;
 
-	if (!gpio_is_ready_dt(&button)) {
-		LOG_ERR("Button device not ready");
+	if (video_stm32u5_dcmi_get_stats(video_dev, &st, true) != 0) {
 		return;
 	}
 
-	ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure button: %d", ret);
-		return;
+	if (st.dropped || st.truncated || st.overruns || st.sync_errors || st.dma_errors) {
+		LOG_WRN("DCMI: %u frames, dropped=%u truncated=%u ovr=%u sync=%u dma=%u "
+			"recovered=%u", st.frames, st.dropped, st.truncated, st.overruns,
+			st.sync_errors, st.dma_errors, st.recoveries);
 	}
+}
 
-	ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_TO_ACTIVE);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure button interrupt: %d", ret);
-		return;
-	}
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_CHARACTERIZE)
+/*
+ * GPDMA profiles tried by the DCMI characterization: bursts valid on any
+ * GPDMA channel (2-word FIFO), both AHB port assignments.
+ */
+static const struct video_stm32u5_dcmi_dma_profile dcmi_char_profiles[] = {
+	{ .src_burst = 1, .dest_burst = 1, .src_port = 0, .dest_port = 1 },
+	{ .src_burst = 2, .dest_burst = 2, .src_port = 0, .dest_port = 1 },
+	{ .src_burst = 1, .dest_burst = 1, .src_port = 0, .dest_port = 0 },
+	{ .src_burst = 2, .dest_burst = 2, .src_port = 1, .dest_port = 1 },
+};
 
-	gpio_init_callback(&button_cb_data, button_pressed_cb, BIT(button.pin));
-	gpio_add_callback(button.port, &button_cb_data);
+#define DCMI_CHAR_FRAMES  30
+#endif
 
-    LOG_INF("===== Camera Config Info =====");
+/* One more frame on screen (any thread: counting only) */
+static void fps_count(void)
+{
+	atomic_inc(&frame_count);
+}
 
-	/* Get display device for writing the captured frame */
-	const struct device *disp = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+/*
+ * camera_thread: log the FPS once per second, only when the value changed,
+ * with the pipeline counters. Kept off the display thread's small stack.
+ */
+static void fps_report(void)
+{
+	int64_t elapsed = k_uptime_get() - fps_start_ms;
 
-	if (!device_is_ready(disp)) {
-		LOG_ERR("> Display device not ready in camera thread");
+	if (elapsed < 1000) {
 		return;
 	}
 
-	/* Allocate video buffers from the video buffer pool */
-	size_t frame_size = CAMERA_W * CAMERA_H * sizeof(uint16_t);
-	struct video_buffer *vbufs[CONFIG_VIDEO_BUFFER_POOL_NUM_MAX];
-
-	for (int i = 0; i < ARRAY_SIZE(vbufs); i++) {
-		vbufs[i] = video_buffer_aligned_alloc(
-				frame_size,
-				CONFIG_VIDEO_BUFFER_POOL_ALIGN,
-				K_FOREVER);
-		if (vbufs[i] == NULL) {
-			LOG_ERR("> Failed to allocate video buffer %d", i);
-			return;
-		}
-		vbufs[i]->type = VIDEO_BUF_TYPE_OUTPUT;
+	fps_current = (float)atomic_clear(&frame_count) * 1000.0f / (float)elapsed;
+	fps_start_ms = k_uptime_get();
+	if (fps_last_logged < 0 ||
+	    fabsf(fps_current - fps_last_logged) >= 0.05f) {
+		LOG_INF("FPS: %.1f", (double)fps_current);
+		fps_last_logged = fps_current;
 	}
+#if CAMERA_BAND_MODE
+	atomic_val_t drops = atomic_clear(&camera_band_drops);
 
-	/* Allocate output buffer: full display width so borders are included */
-	uint8_t *disp_buf = k_malloc(DISPLAY_W * DISPLAY_H * sizeof(uint16_t));
+	if (drops > 0) {
+		LOG_WRN("Bands dropped: %u", (uint32_t)drops);
+	}
+#endif
+#if !CAMERA_BAND_MODE
+	atomic_val_t full = atomic_clear(&disp_bytes_full);
+	atomic_val_t sent = atomic_clear(&disp_bytes_sent);
 
-	if (disp_buf == NULL) {
-		LOG_ERR("> Failed to allocate camera display buffer");
-		return;
+	if (full > 0) {
+		LOG_DBG("Panel: %u of %u bytes sent (%u%%)", (uint32_t)sent, (uint32_t)full,
+			(uint32_t)((uint64_t)sent * 100U / full));
 	}
+#endif
+#if CAMERA_STREAM
+	struct frame_stream_stats st;
 
-	/* Log the format the DCMI driver actually stored */
-	struct video_format active_fmt = { .type = VIDEO_BUF_TYPE_OUTPUT };
+	frame_stream_get_stats(&st, true);
+	if (st.raw_bytes > 0) {
+		LOG_DBG("Stream: %u sent, %u busy, %u too big, %u%% of raw", st.sent, st.busy,
+			st.too_big, (uint32_t)((uint64_t)st.payload_bytes * 100U / st.raw_bytes));
+	}
+#endif
+	log_dcmi_stats();
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_ISR_STATS)
+	log_dcmi_isr_stats();
+#endif
+}
 
-	video_get_format(video_dev, &active_fmt);
-	LOG_INF("DCMI fmt: %ux%u pitch=%u pixfmt=0x%08x",
-		active_fmt.width, active_fmt.height,
-		active_fmt.pitch, active_fmt.pixelformat);
-	LOG_INF("Vbuf size=%u, buf[0]=%p",
-		(uint32_t)frame_size, (void *)vbufs[0]->buffer);
+#if CAMERA_BAND_MODE
+struct camera_band {
+	struct video_buffer *vbuf;
+	uint16_t line_offset;
+	uint16_t lines;
+};
 
-	// LOG_INF("Streaming in %s mode\n",
-	// 	CAMERA_CAPTURE_MODE_CONTINUOUS ? "continuous" : "snapshot");
-	LOG_INF("\n");
+K_MSGQ_DEFINE(camera_band_msgq, sizeof(struct camera_band), 16, 4);
 
-	/* Wait for SW0 press before starting capture; then run until power cycle */
-	k_sem_take(&capture_sem, K_FOREVER);
+/* DCMI band-complete callback (ISR context): hand the band to camera_thread */
+static void camera_band_cb(const struct device *dev, struct video_buffer *vbuf,
+			   void *user_data)
+{
+	struct camera_band band = {
+		.vbuf = vbuf,
+		.line_offset = vbuf->line_offset,
+		.lines = vbuf->bytesused / camera_fmt.pitch - vbuf->line_offset,
+	};
+	uint32_t stale;
 
-	LOG_INF("Capture started");
+	if (k_msgq_put(&camera_band_msgq, &band, K_NO_WAIT) == 0) {
+		return;
+	}
 
-	/* Enqueue all buffers before starting */
-	for (int i = 0; i < ARRAY_SIZE(vbufs); i++) {
-		ret = video_enqueue(video_dev, vbufs[i]);
-		if (ret < 0) {
-			LOG_ERR("> video_enqueue[%d] failed: %d", i, ret);
-			return;
-		}
+	if (band.line_offset + band.lines < camera_fmt.height) {
+		atomic_inc(&camera_band_drops);
+		return;
 	}
 
-	frame_count = 0;
-	fps_start_ms = k_uptime_get();
+	/*
+	 * The last band ends the frame: the loop recycles the buffer on it, so
+	 * it takes the place of the queued bands, which are late by now.
+	 */
+	stale = k_msgq_num_used_get(&camera_band_msgq);
+	k_msgq_purge(&camera_band_msgq);
+	atomic_add(&camera_band_drops, stale);
 
-	while (1) {
-		struct video_buffer *vbuf;
+	if (k_msgq_put(&camera_band_msgq, &band, K_NO_WAIT) != 0) {
+		atomic_inc(&camera_band_drops);
+	}
+}
 
-		/* DCMI driver captures one frame per start; both modes need start per frame */
-		ret = video_stream_start(video_dev, VIDEO_BUF_TYPE_OUTPUT);
-		if (ret < 0) {
-			LOG_ERR("> Failed to start video stream: %d", ret);
-			video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
-			{
-				struct video_buffer *tmp;
-				while (video_dequeue(video_dev, &tmp, K_NO_WAIT) == 0) {
-					video_enqueue(video_dev, tmp);
-				}
-			}
-			k_msleep(100);
-			continue;
-		}
+/*
+ * Band loop: copy, overlay and send each band to the panel as soon as the
+ * DMA has written it; the frame buffer is recycled after its last band.
+ */
+static void camera_band_loop(const struct device *disp, uint8_t *disp_buf)
+{
+	const struct draw_target target = DRAW_TARGET_DISPLAY(disp_buf);
+	struct camera_band band;
+	struct video_buffer *vbuf;
+	struct display_buffer_descriptor desc = {
+		.buf_size = DISPLAY_W * DISPLAY_H * sizeof(uint16_t),
+		.width  = DISPLAY_W,
+		.height = DISPLAY_H,
+		.pitch  = DISPLAY_W,
+	};
 
-		ret = video_dequeue(video_dev, &vbuf, K_MSEC(100));
-		if (ret < 0) {
-			video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
-			{
-				struct video_buffer *tmp;
-				while (video_dequeue(video_dev, &tmp, K_NO_WAIT) == 0) {
-					video_enqueue(video_dev, tmp);
-				}
-			}
-			k_msleep(1);
+	/* Borders are written once; bands only cover the camera region */
+	display_write(disp, 0, 0, &desc, disp_buf);
+	atomic_set(&show_camera_frame, 1);
+
+	while (1) {
+		if (k_msgq_get(&camera_band_msgq, &band, K_FOREVER) != 0) {
 			continue;
 		}
 
-		video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
-
-		copy_frame_to_display(vbuf->buffer, disp_buf);
+		int y = frame_y + band.line_offset;
 
-		atomic_set(&show_camera_frame, 1);
+		copy_rows_to_display(band.vbuf->buffer, disp_buf, band.line_offset, band.lines);
+		draw_sine_overlay(&target, y, y + band.lines - 1);
 
-		struct display_buffer_descriptor desc = {
-			.buf_size = DISPLAY_W * DISPLAY_H * sizeof(uint16_t),
-			.width  = DISPLAY_W,
-			.height = DISPLAY_H,
-			.pitch  = DISPLAY_W,
-		};
+		desc.buf_size = DISPLAY_W * band.lines * sizeof(uint16_t);
+		desc.height = band.lines;
+		display_write(disp, 0, y, &desc, disp_buf + y * DISPLAY_W * sizeof(uint16_t));
 
-		display_write(disp, 0, 0, &desc, disp_buf);
-
-		/* FPS measurement: log once per second, only when value changed */
-		frame_count++;
-		{
-			int64_t elapsed = k_uptime_get() - fps_start_ms;
-			if (elapsed >= 1000) {
-				fps_current = (float)frame_count * 1000.0f / (float)elapsed;
-				frame_count = 0;
-				fps_start_ms = k_uptime_get();
-				if (fps_last_logged < 0 ||
-				    fabsf(fps_current - fps_last_logged) >= 0.05f) {
-					LOG_INF("FPS: %.1f", (double)fps_current);
-					fps_last_logged = fps_current;
-				}
-			}
+		if (band.line_offset + band.lines < camera_fmt.height) {
+			continue;
 		}
 
-		/* Re-enqueue for next capture */
-		video_enqueue(video_dev, vbuf);
-
-		/* Drain any extra buffers */
-		{
-			struct video_buffer *tmp;
-			while (video_dequeue(video_dev, &tmp, K_NO_WAIT) == 0) {
-				video_enqueue(video_dev, tmp);
-			}
+		/* Last band: the frame event hands the buffer out right after it */
+		if (video_dequeue(video_dev, &vbuf, K_MSEC(100)) == 0) {
+			fps_count();
+			fps_report();
+			video_enqueue(video_dev, vbuf);
 		}
 	}
 }
+#endif /* CAMERA_BAND_MODE */
 
-
-void display_thread(void)
+/*
+ * Set the DCMI (and so the sensor) format, then the OV5640 settings the
+ * sensor driver rewrites with every format: RGB565 byte order and flips.
+ */
+static int camera_set_format(struct video_format *fmt)
 {
-	size_t rect_w;
-	size_t rect_h;
-	size_t h_step;
-	size_t scale;
-	uint8_t *buf;
-	int32_t grey_scale_sleep;
-	const struct device *display_dev;
-	struct display_capabilities capabilities;
-	struct display_buffer_descriptor buf_desc;
-	size_t buf_size = 0;
+	int ret;
 
-	display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
-	if (!device_is_ready(display_dev)) {
-		LOG_ERR("Device %s not found. Aborting sample.",
-			display_dev->name);
-		return;
+	ret = video_set_format(video_dev, fmt);
+	if (ret < 0) {
+		return ret;
 	}
 
-	// LOG_INF("Display %s Thread Starts", display_dev->name);
-	display_get_capabilities(display_dev, &capabilities);
+#if CAMERA_HAS_OV5640
+	/*
+	 * Override OV5640 FORMAT CONTROL 00 (0x4300) to 0x61 (RGB565 2X8 BE) so
+	 * the sensor output matches the display byte order and no per-pixel
+	 * swap is needed. Done here so we don't have to patch the Zephyr driver.
+	 */
+	if (fmt->pixelformat == VIDEO_PIX_FMT_RGB565) {
+		const struct device *i2c_dev = DEVICE_DT_GET(DT_PARENT(DT_NODELABEL(ov5640)));
+		uint8_t ov5640_addr = DT_REG_ADDR(DT_NODELABEL(ov5640));
+		uint8_t fmt_ctrl[] = { 0x43, 0x00, 0x61 }; /* 0x4300 = 0x61 */
 
-	if (capabilities.screen_info & SCREEN_INFO_MONO_VTILED) {
-		rect_w = 16;
-		rect_h = 8;
-	} else {
-		rect_w = 2;
-		rect_h = 1;
+		if (device_is_ready(i2c_dev)) {
+			ret = i2c_write(i2c_dev, fmt_ctrl, sizeof(fmt_ctrl), ov5640_addr);
+			if (ret != 0) 
+			{
+				LOG_WRN("> OV5640 0x4300 override failed: %d (colors may be wrong)", ret);
+			}
+			// else 
+			// {
+			// 	LOG_INF("> OV5640 0x4300 set to 0x61 (RGB565 BE)");
+			// }
+		} else {
+			LOG_WRN("> OV5640 I2C bus not ready, skip 0x4300 override");
+		}
 	}
 
-	if ((capabilities.x_resolution < 3 * rect_w) ||
-	    (capabilities.y_resolution < 3 * rect_h) ||
-	    (capabilities.x_resolution < 8 * rect_h)) {
-		rect_w = capabilities.x_resolution * 40 / 100;
-		rect_h = capabilities.y_resolution * 40 / 100;
-		h_step = capabilities.y_resolution * 20 / 100;
-		scale = 1;
-	} else {
-		h_step = rect_h;
-		scale = (capabilities.x_resolution / 8) / rect_h;
-	}
+	/*
+	 * Flip controls: video_set_ctrl skips the driver when new value equals
+	 * current (default 0). Resolution params set 0x3820/0x3821, so we must
+	 * force a write by setting the opposite value first.
+	 */
+	struct video_control ctrl;
 
-	rect_w *= scale;
+	ctrl.id = VIDEO_CID_HFLIP;
+	ctrl.val = !CAMERA_HFLIP;
+	video_set_ctrl(ov5640, &ctrl);
+	ctrl.val = CAMERA_HFLIP;
+	if (video_set_ctrl(ov5640, &ctrl)) {
+		LOG_ERR("> Failed to set HFLIP");
+	}
+
+	ctrl.id = VIDEO_CID_VFLIP;
+	ctrl.val = !CAMERA_VFLIP;
+	video_set_ctrl(ov5640, &ctrl);
+	ctrl.val = CAMERA_VFLIP;
+	if (video_set_ctrl(ov5640, &ctrl)) {
+		LOG_ERR("> Failed to set VFLIP");
+	}
+#endif
+
+	return 0;
+}
+
+/*
+ * Place a capture format on the panel, after rotation: 1:1 when it fits,
+ * or scaled to the largest size with its aspect ratio (FIT) or to the
+ * whole panel (FILL). Centred, with an even width and x so that rows are
+ * written a 32-bit word at a time.
+ */
+static int camera_layout(const struct video_format *fmt)
+{
+	uint16_t w = fmt->width;
+	uint16_t h = fmt->height;
+
+#if CAMERA_SCALING
+	const bool portrait = (CAMERA_ORIENT & FRAME_SCALE_TRANSPOSE) != 0;
+	const uint16_t src_w = portrait ? fmt->height : fmt->width;
+	const uint16_t src_h = portrait ? fmt->width : fmt->height;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_APP_CAMERA_SCALE_FILL)) {
+		w = DISPLAY_W;
+		h = DISPLAY_H;
+	} else if (IS_ENABLED(CONFIG_APP_CAMERA_SCALE_NONE) &&
+		   src_w <= DISPLAY_W && src_h <= DISPLAY_H) {
+		w = src_w & ~1U;
+		h = src_h;
+	} else if (src_w * DISPLAY_H <= DISPLAY_W * src_h) {
+		w = (src_w * DISPLAY_H / src_h) & ~1U;
+		h = DISPLAY_H;
+	} else {
+		w = DISPLAY_W;
+		h = src_h * DISPLAY_W / src_w;
+	}
+
+	ret = frame_scale_init(&camera_scale, fmt->width, fmt->height, w, h,
+			       IS_ENABLED(CONFIG_APP_CAMERA_SCALE_BILINEAR) ?
+			       FRAME_SCALE_BILINEAR : FRAME_SCALE_NEAREST, CAMERA_ORIENT);
+	if (ret < 0) {
+		LOG_ERR("> Cannot scale %ux%u to %ux%u", fmt->width, fmt->height, w, h);
+		return ret;
+	}
+#endif
+
+	frame_w = w;
+	frame_h = h;
+	frame_x = ((DISPLAY_W - w) / 2) & ~1U;
+	frame_y = (DISPLAY_H - h) / 2;
+
+	return 0;
+}
+
+/*
+ * (Re)allocate the capture buffers from the video buffer pool. All of them
+ * are released first, so that a larger size reuses the same pool memory.
+ */
+static int camera_alloc_buffers(struct video_buffer **vbufs, size_t count, size_t size)
+{
+	for (int i = 0; i < count; i++) {
+		if (vbufs[i] != NULL) {
+			video_buffer_release(vbufs[i]);
+			vbufs[i] = NULL;
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		vbufs[i] = video_buffer_aligned_alloc(size, CONFIG_VIDEO_BUFFER_POOL_ALIGN,
+						      K_NO_WAIT);
+		if (vbufs[i] == NULL) {
+			LOG_ERR("> Failed to allocate video buffer %d", i);
+			return -ENOMEM;
+		}
+		vbufs[i]->type = VIDEO_BUF_TYPE_OUTPUT;
+	}
+
+	return 0;
+}
+
+/* Start the stream on the enqueued buffers, with fresh FPS and pacing state */
+static int camera_stream_begin(void)
+{
+	int ret;
+
+	atomic_clear(&frame_count);
+	fps_start_ms = k_uptime_get();
+
+#if CAMERA_PACING
+	ret = frame_pacer_init(video_dev, CONFIG_APP_FRAME_PACER_TARGET_FPS,
+			       CONFIG_APP_FRAME_PACER_MIN_FPS);
+	if (ret < 0) {
+		/* Keep the sensor's own frame rate */
+		LOG_WRN("> Frame pacing disabled: %d", ret);
+	}
+#endif
+
+#if CAMERA_BAND_MODE
+	ret = video_stm32u5_dcmi_set_band_callback(video_dev, camera_band_cb, NULL);
+	if (ret < 0) {
+		LOG_ERR("> Failed to set band callback: %d", ret);
+		return ret;
+	}
+#endif
+
+	/*
+	 * Continuous: sensor and DCMI keep running; buffers cycle through
+	 * enqueue/dequeue. Snapshot: one frame per start, restarted by
+	 * camera_frames_ready().
+	 */
+	ret = video_stream_start(video_dev, VIDEO_BUF_TYPE_OUTPUT);
+	if (ret < 0) {
+		LOG_ERR("> Failed to start video stream: %d", ret);
+	}
+
+	return ret;
+}
+
+/* Enqueue all buffers and start the stream (SW0 pressed) */
+static int camera_capture_start(struct video_buffer **vbufs, size_t count)
+{
+	int ret;
+
+	LOG_INF("Capture started");
+
+	/* Enqueue all buffers before starting */
+	for (int i = 0; i < count; i++) {
+		ret = video_enqueue(video_dev, vbufs[i]);
+		if (ret < 0) {
+			LOG_ERR("> video_enqueue[%d] failed: %d", i, ret);
+			return ret;
+		}
+	}
+
+#if defined(CONFIG_VIDEO_STM32U5_DCMI_CHARACTERIZE)
+	/* Results are logged by the driver, one line per run */
+	ret = video_stm32u5_dcmi_characterize(video_dev, dcmi_char_profiles,
+					      ARRAY_SIZE(dcmi_char_profiles),
+					      DCMI_CHAR_FRAMES, NULL, NULL);
+	if (ret < 0) {
+		LOG_WRN("> DCMI characterization failed: %d", ret);
+	}
+	/* Drop what the characterization runs signalled */
+	k_poll_signal_reset(&camera_signal);
+#endif
+
+	return camera_stream_begin();
+}
+
+#if !CAMERA_BAND_MODE
+/* Time since start, and move start to now */
+static uint32_t camera_lap(uint32_t *start)
+{
+	uint32_t now = k_cycle_get_32();
+	uint32_t lap = now - *start;
+
+	*start = now;
+
+	return lap;
+}
+
+#if CAMERA_ZERO_COPY
+/*
+ * Zero-copy compose stage: draw the overlay straight into the captured
+ * frame and submit the changed tiles of that frame at the camera offset.
+ * The video buffer goes back to the driver once the panel has it.
+ */
+static void compose_thread(void)
+{
+	static struct tile_diff diff;
+	struct display_buffer_descriptor desc = { 0 };
+	struct display_async_rect rects[DISPLAY_ASYNC_MAX_RECTS];
+	struct camera_frame frame;
+	struct video_buffer *vbuf;
+	bool reset = true;
+	bool tiles = false;
+	size_t num_rects;
+	int ret;
+	uint32_t bytes;
+	uint32_t start;
+	uint32_t t0;
+
+	while (1) {
+		k_msgq_get(&compose_msgq, &frame, K_FOREVER);
+		vbuf = frame.vbuf;
+
+		if (vbuf == NULL) {
+			/* Drain: the panel and the sinks hand the last frames back */
+			k_sem_take(&panel_idle_sem, K_FOREVER);
+			k_sem_give(&panel_idle_sem);
+#if CAMERA_STREAM || CAMERA_RECORD
+			k_sem_take(&camera_tap_idle_sem, K_FOREVER);
+			k_sem_give(&camera_tap_idle_sem);
+#endif
+			/* The camera thread clears the panel before the next frame */
+			tile_diff_invalidate(&diff);
+			reset = true;
+			k_sem_give(&compose_idle_sem);
+			continue;
+		}
+
+		if (reset) {
+			const struct display_buffer_descriptor prev = desc;
+
+			reset = false;
+			desc = (struct display_buffer_descriptor){
+				.buf_size = camera_fmt.pitch * camera_fmt.height,
+				.width  = camera_fmt.width,
+				.height = camera_fmt.height,
+				.pitch  = camera_fmt.pitch / sizeof(uint16_t),
+			};
+			/* Same frame geometry: the invalidated tiles are reused */
+			if (!tiles || desc.width != prev.width || desc.height != prev.height ||
+			    desc.pitch != prev.pitch) {
+				ret = tile_diff_init(&diff, 0, 0, desc.width, desc.height,
+						     desc.pitch);
+				tiles = ret == 0;
+				if (!tiles) {
+					LOG_WRN("Camera frame %ux%u not tiled (%d), "
+						"sending whole frames", desc.width, desc.height,
+						ret);
+				}
+			}
+		}
+
+		start = k_cycle_get_32();
+		t0 = start;
+		latency_hist_record(&camera_latency[CAMERA_STAGE_QUEUE],
+				    start - frame.dequeue_cycles);
+
+		struct draw_target t = {
+			.buf = vbuf->buffer,
+			.x = frame_x,
+			.y = frame_y,
+			.w = desc.width,
+			.h = desc.height,
+		};
+
+		draw_sine_overlay(&t, frame_y, frame_y + desc.height - 1);
+		latency_hist_record(&camera_latency[CAMERA_STAGE_OVERLAY], camera_lap(&t0));
+
+		if (tiles) {
+			num_rects = tile_diff_update(&diff, vbuf->buffer, rects, ARRAY_SIZE(rects));
+		} else {
+			rects[0] = (struct display_async_rect){ .w = desc.width, .h = desc.height };
+			num_rects = 1;
+		}
+		latency_hist_record(&camera_latency[CAMERA_STAGE_DIFF], camera_lap(&t0));
+
+		bytes = 0;
+		for (size_t i = 0; i < num_rects; i++) {
+			bytes += rects[i].w * rects[i].h * sizeof(uint16_t);
+		}
+		atomic_add(&disp_bytes_sent, bytes);
+		atomic_add(&disp_bytes_full, DISPLAY_W * DISPLAY_H * sizeof(uint16_t));
+
+#if CAMERA_PACING
+		frame_pacer_stage_time(FRAME_PACER_COMPOSE,
+				       k_cyc_to_us_floor32(k_cycle_get_32() - start));
+#endif
+
+		const struct camera_glass glass = {
+			.buf = vbuf->buffer,
+			.vsync_cycles = frame.vsync_cycles,
+		};
+
+		k_sem_take(&panel_idle_sem, K_FOREVER);
+		panel_vbuf = vbuf;
+		k_msgq_put(&glass_msgq, &glass, K_NO_WAIT);
+		display_async_submit_rects(vbuf->buffer, frame_x, frame_y, &desc, rects, num_rects,
+					   K_FOREVER);
+	}
+}
+#else
+/*
+ * Copy a captured frame into the camera region of a display buffer, scaled
+ * and rotated in the same pass.
+ */
+static void camera_copy_frame(uint8_t *src, uint8_t *dst)
+{
+#if CAMERA_SCALING
+	if (camera_fmt.pixelformat == VIDEO_PIX_FMT_YUYV) {
+		/* The scaler reads RGB565: convert the captured frame first */
+		for (int y = 0; y < camera_fmt.height; y++) {
+			uint8_t *row = src + y * camera_fmt.pitch;
+
+			yuyv_row_to_rgb565(row, row, camera_fmt.width);
+		}
+	}
+
+	frame_scale_rows(&camera_scale, src, camera_fmt.pitch,
+			 dst + (frame_y * DISPLAY_W + frame_x) * sizeof(uint16_t),
+			 DISPLAY_W * sizeof(uint16_t), 0, frame_h);
+#else
+	copy_rows_to_display(src, dst, 0, camera_fmt.height);
+#endif
+}
+
+/*
+ * Compose stage: copy a captured frame into a free display buffer and draw
+ * the overlay, give the video buffer back to the driver as soon as its
+ * pixels are copied, then submit the display buffer without waiting for
+ * the panel transfer; the next frame is composed into the other buffer.
+ *
+ * The whole panel is sent for the first frame (it also clears the standby
+ * text) and when a new format moves the camera region; otherwise the
+ * borders do not change and only camera tiles whose hash changed since
+ * the previous frame are sent, merged into rectangles.
+ */
+static void compose_thread(void)
+{
+	static struct tile_diff diff;
+	struct display_buffer_descriptor desc = {
+		.buf_size = DISPLAY_W * DISPLAY_H * sizeof(uint16_t),
+		.width  = DISPLAY_W,
+		.height = DISPLAY_H,
+		.pitch  = DISPLAY_W,
+	};
+	struct display_async_rect rects[DISPLAY_ASYNC_MAX_RECTS];
+	/* Camera region the tiles cover, none yet */
+	struct display_async_rect region = { 0 };
+	uint8_t *bufs[CAMERA_DISP_BUFS];
+	struct camera_frame frame;
+	uint8_t *disp_buf;
+	bool whole;
+	bool tiles = false;
+	size_t num_rects;
+	int ret;
+	uint32_t bytes;
+	uint32_t start;
+	uint32_t t0;
+
+	while (1) {
+		k_msgq_get(&compose_msgq, &frame, K_FOREVER);
+
+		if (frame.vbuf == NULL) {
+			/*
+			 * Drain: once every display buffer is back the panel is
+			 * idle. Clear them for the next geometry's borders and
+			 * return them without writing anything.
+			 */
+			for (int i = 0; i < ARRAY_SIZE(bufs); i++) {
+				bufs[i] = display_async_get_buffer(K_FOREVER);
+				memset(bufs[i], 0x00, desc.buf_size);
+			}
+			for (int i = 0; i < ARRAY_SIZE(bufs); i++) {
+				display_async_submit_rects(bufs[i], 0, 0, &desc, rects, 0, K_FOREVER);
+			}
+			/* The new format starts from a complete camera region */
+			tile_diff_invalidate(&diff);
+			k_sem_give(&compose_idle_sem);
+			continue;
+		}
+
+		/* First frame or moved region: new tiles, and the borders change */
+		whole = region.x != frame_x || region.y != frame_y || region.w != frame_w ||
+			region.h != frame_h;
+		if (whole) {
+			region = (struct display_async_rect){
+				.x = frame_x, .y = frame_y, .w = frame_w, .h = frame_h,
+			};
+			ret = tile_diff_init(&diff, frame_x, frame_y, frame_w, frame_h, DISPLAY_W);
+			tiles = ret == 0;
+			if (!tiles) {
+				LOG_WRN("Camera region %ux%u not tiled (%d), sending whole frames",
+					frame_w, frame_h, ret);
+			}
+		}
+
+		disp_buf = display_async_get_buffer(K_FOREVER);
+
+		start = k_cycle_get_32();
+		t0 = start;
+		latency_hist_record(&camera_latency[CAMERA_STAGE_QUEUE],
+				    start - frame.dequeue_cycles);
+
+		/* Camera region only: the borders were cleared at allocation */
+		camera_copy_frame(frame.vbuf->buffer, disp_buf);
+		latency_hist_record(&camera_latency[CAMERA_STAGE_COPY], camera_lap(&t0));
+
+		/* Re-enqueue for next capture */
+		video_enqueue(video_dev, frame.vbuf);
+		latency_hist_record(&camera_latency[CAMERA_STAGE_ENQUEUE], camera_lap(&t0));
+
+		const struct draw_target t = DRAW_TARGET_DISPLAY(disp_buf);
+
+		draw_sine_overlay(&t, 0, DISPLAY_H - 1);
+		latency_hist_record(&camera_latency[CAMERA_STAGE_OVERLAY], camera_lap(&t0));
+
+		num_rects = tiles ? tile_diff_update(&diff, disp_buf, rects, ARRAY_SIZE(rects)) : 0;
+		latency_hist_record(&camera_latency[CAMERA_STAGE_DIFF], camera_lap(&t0));
+
+		if (whole || !tiles) {
+			rects[0] = (struct display_async_rect){ .w = DISPLAY_W, .h = DISPLAY_H };
+			num_rects = 1;
+		}
+
+		bytes = 0;
+		for (size_t i = 0; i < num_rects; i++) {
+			bytes += rects[i].w * rects[i].h * sizeof(uint16_t);
+		}
+		atomic_add(&disp_bytes_sent, bytes);
+		atomic_add(&disp_bytes_full, desc.buf_size);
+
+#if CAMERA_PACING
+		frame_pacer_stage_time(FRAME_PACER_COMPOSE,
+				       k_cyc_to_us_floor32(k_cycle_get_32() - start));
+#endif
+
+		const struct camera_glass glass = {
+			.buf = disp_buf,
+			.vsync_cycles = frame.vsync_cycles,
+		};
+
+		k_msgq_put(&glass_msgq, &glass, K_NO_WAIT);
+		display_async_submit_rects(disp_buf, 0, 0, &desc, rects, num_rects, K_FOREVER);
+	}
+}
+#endif /* CAMERA_ZERO_COPY */
+
+#if CAMERA_STREAM || CAMERA_RECORD
+/* Sinks still reading the lent frame, plus one while it is being offered */
+static atomic_t camera_tap_refs;
+static uint8_t *camera_tap_buf;
+#if CAMERA_ZERO_COPY
+static struct video_buffer *camera_tap_vbuf;
+#endif
+
+/* Back to the pipeline: the driver (zero-copy) or the display free list */
+static void camera_tap_return(void)
+{
+#if CAMERA_ZERO_COPY
+	video_enqueue(video_dev, camera_tap_vbuf);
+#else
+	display_async_release(camera_tap_buf);
+#endif
+	k_sem_give(&camera_tap_idle_sem);
+}
+
+/* Sink thread: done encoding the lent frame */
+static void camera_tap_done(const uint8_t *buf, void *user_data)
+{
+	if (atomic_dec(&camera_tap_refs) == 1) {
+		camera_tap_return();
+	}
+}
+
+/*
+ * Offer a frame the panel just got to the stream and recorder sinks. They
+ * only take it here and encode it in their own threads. Returns true if
+ * the frame is lent: camera_tap_done() returns it, not the caller.
+ */
+static bool camera_frame_tap(uint8_t *buf)
+{
+#if CAMERA_ZERO_COPY
+	const uint16_t w = camera_fmt.width;
+	const uint16_t h = camera_fmt.height;
+	const uint16_t pitch = camera_fmt.pitch / sizeof(uint16_t);
+#else
+	const uint16_t w = DISPLAY_W;
+	const uint16_t h = DISPLAY_H;
+	const uint16_t pitch = DISPLAY_W;
+#endif
+
+	/* Still lent: the sinks would be busy with it anyway */
+	if (k_sem_take(&camera_tap_idle_sem, K_NO_WAIT) != 0) {
+		return false;
+	}
+
+	camera_tap_buf = buf;
+#if CAMERA_ZERO_COPY
+	camera_tap_vbuf = panel_vbuf;
+#endif
+	atomic_set(&camera_tap_refs, 1);
+
+#if CAMERA_STREAM
+	if (frame_stream_submit(buf, w, h, pitch)) {
+		atomic_inc(&camera_tap_refs);
+	}
+#endif
+#if CAMERA_RECORD
+	if (frame_record_submit(buf, w, h, pitch)) {
+		atomic_inc(&camera_tap_refs);
+	}
+#endif
+
+	/* Not taken, or already encoded: the caller keeps it */
+	if (atomic_dec(&camera_tap_refs) == 1) {
+		k_sem_give(&camera_tap_idle_sem);
+		return false;
+	}
+
+	return true;
+}
+#endif
+
+/* Panel stage completion (display_async thread): one more frame on screen */
+static void camera_frame_shown(uint8_t *buf, int ret, void *user_data)
+{
+	uint32_t now = k_cycle_get_32();
+	struct camera_glass glass;
+	bool lent = false;
+
+	/* Camera frames only: the buffers a drain hands back carry no stamp */
+	if (k_msgq_peek(&glass_msgq, &glass) != 0 || glass.buf != buf) {
+		return;
+	}
+	k_msgq_get(&glass_msgq, &glass, K_NO_WAIT);
+
+#if CAMERA_STREAM || CAMERA_RECORD
+	lent = ret == 0 && camera_frame_tap(buf);
+#endif
+
+#if CAMERA_ZERO_COPY
+	/* The panel has the pixels: the driver can refill the frame */
+	if (!lent) {
+		video_enqueue(video_dev, panel_vbuf);
+		latency_hist_record(&camera_latency[CAMERA_STAGE_ENQUEUE],
+				    k_cycle_get_32() - now);
+	}
+	k_sem_give(&panel_idle_sem);
+#else
+	if (lent) {
+		display_async_hold(buf);
+	}
+#endif
+
+	if (ret < 0) {
+		return;
+	}
+
+	latency_hist_record(&camera_latency[CAMERA_STAGE_DISPLAY], display_async_busy_cycles());
+	latency_hist_record(&camera_latency[CAMERA_STAGE_GLASS], now - glass.vsync_cycles);
+
+#if CAMERA_PACING
+	frame_pacer_stage_time(FRAME_PACER_PANEL, display_async_busy_usec());
+#endif
+
+	atomic_set(&show_camera_frame, 1);
+	fps_count();
+}
+
+/*
+ * Log min/avg/p99/max of every stage, or print them on a shell, and
+ * optionally start new histograms.
+ */
+static void camera_latency_dump(const struct shell *sh, bool reset)
+{
+	struct latency_hist_summary s;
+
+	for (int i = 0; i < CAMERA_STAGES; i++) {
+		latency_hist_summarize(&camera_latency[i], &s, reset);
+#if defined(CONFIG_SHELL)
+		if (sh != NULL) {
+			shell_print(sh, "%-8s n=%u min=%u avg=%u p99=%u max=%u us",
+				    camera_stage_names[i], s.count, s.min_us, s.avg_us, s.p99_us,
+				    s.max_us);
+			continue;
+		}
+#endif
+		LOG_INF("%-8s n=%u min=%u avg=%u p99=%u max=%u us", camera_stage_names[i],
+			s.count, s.min_us, s.avg_us, s.p99_us, s.max_us);
+	}
+}
+
+#if defined(CONFIG_SHELL)
+/* Print the non-empty histogram buckets of every stage */
+static void camera_latency_buckets(const struct shell *sh)
+{
+	/* Off the shell thread's stack */
+	static uint32_t buckets[LATENCY_HIST_BUCKETS];
+
+	for (int i = 0; i < CAMERA_STAGES; i++) {
+		latency_hist_buckets(&camera_latency[i], buckets);
+		shell_print(sh, "%s:", camera_stage_names[i]);
+		for (size_t b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+			uint32_t floor;
+
+			if (buckets[b] == 0) {
+				continue;
+			}
+			floor = latency_hist_bucket_floor(b);
+			shell_print(sh, "  >= %u us (%u cycles): %u", k_cyc_to_us_floor32(floor),
+				    floor, buckets[b]);
+		}
+	}
+}
+
+static int cmd_latency(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "buckets") == 0) {
+		camera_latency_buckets(sh);
+		return 0;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "reset") != 0) {
+		shell_error(sh, "Usage: latency [reset|buckets]");
+		return -EINVAL;
+	}
+
+	camera_latency_dump(sh, argc > 1);
+
+	return 0;
+}
+
+SHELL_CMD_ARG_REGISTER(latency, NULL, "Camera pipeline stage latencies, or [reset|buckets]",
+		       cmd_latency, 1, 1);
+#endif
+
+#if CAMERA_RECORD && defined(CONFIG_SHELL)
+static int cmd_record(const struct shell *sh, size_t argc, char **argv)
+{
+	struct frame_record_stats s;
+
+	if (argc > 1 && strcmp(argv[1], "snap") == 0) {
+		frame_record_request();
+		return 0;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "flush") == 0) {
+		frame_record_flush();
+		return 0;
+	}
+
+	if (argc > 1) {
+		shell_error(sh, "Usage: record [snap|flush]");
+		return -EINVAL;
+	}
+
+	frame_record_get_stats(&s, false);
+	shell_print(sh, "%u records (%u%% of raw), %u busy, %u too big", s.records,
+		    s.raw_bytes > 0 ? (uint32_t)((uint64_t)s.payload_bytes * 100U / s.raw_bytes) : 0,
+		    s.busy, s.too_big);
+	if (s.flash_us > 0 && s.elapsed_ms > 0) {
+		shell_print(sh, "%u KiB in %u pages over %u s: %u KiB/s sustained, "
+			    "%u KiB/s while writing (flash busy %u%%)",
+			    s.flash_bytes / 1024, s.pages, s.elapsed_ms / 1000,
+			    (uint32_t)((uint64_t)s.flash_bytes * 1000U / 1024U / s.elapsed_ms),
+			    (uint32_t)((uint64_t)s.flash_bytes * 1000000U / 1024U / s.flash_us),
+			    (uint32_t)((uint64_t)s.flash_us / 10U / s.elapsed_ms));
+	}
+
+	return 0;
+}
+
+SHELL_CMD_ARG_REGISTER(record, NULL, "Frame recorder counters, or [snap|flush]", cmd_record,
+		       1, 1);
+#endif
+
+#if CAMERA_ZERO_COPY
+/* Write the whole panel black, one row at a time (no frame-sized buffer) */
+static int camera_clear_display(const struct device *disp)
+{
+	static uint16_t black_row[DISPLAY_W];
+	struct display_buffer_descriptor desc = {
+		.buf_size = sizeof(black_row),
+		.width  = DISPLAY_W,
+		.height = 1,
+		.pitch  = DISPLAY_W,
+	};
+	int ret;
+
+	for (int y = 0; y < DISPLAY_H; y++) {
+		ret = display_write(disp, 0, y, &desc, black_row);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/* Frame-ready signal: pass every frame the driver has handed out to compose */
+static void camera_frames_ready(void)
+{
+	struct camera_frame frame;
+	unsigned int signaled;
+	int result;
+
+	k_poll_signal_check(&camera_signal, &signaled, &result);
+	k_poll_signal_reset(&camera_signal);
+
+	if (result != VIDEO_BUF_DONE) {
+		/* Capture error: the DCMI driver restarts the capture by itself */
+		return;
+	}
+
+	/* Snapshot: DCMI driver captures one frame per start */
+	if (!CAMERA_CAPTURE_MODE_CONTINUOUS) {
+		video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
+	}
+
+	while (video_dequeue(video_dev, &frame.vbuf, K_NO_WAIT) == 0) {
+		struct video_stm32u5_dcmi_frame_meta meta;
+
+		frame.dequeue_cycles = k_cycle_get_32();
+		frame.vsync_cycles = frame.dequeue_cycles;
+
+		if (video_stm32u5_dcmi_get_frame_meta(video_dev, frame.vbuf, &meta) == 0) {
+			frame.vsync_cycles = meta.vsync_cycles;
+#if CAMERA_PACING
+			frame_pacer_frame(meta.dropped);
+#endif
+		}
+		latency_hist_record(&camera_latency[CAMERA_STAGE_CAPTURE],
+				    frame.dequeue_cycles - frame.vsync_cycles);
+
+		/* Blocks while compose is busy: the driver keeps the other buffers */
+		k_msgq_put(&compose_msgq, &frame, K_FOREVER);
+	}
+
+	if (!CAMERA_CAPTURE_MODE_CONTINUOUS &&
+	    video_stream_start(video_dev, VIDEO_BUF_TYPE_OUTPUT) < 0) {
+		LOG_ERR("> Failed to restart video stream");
+	}
+}
+
+#if CAMERA_PACING
+/* Move to the operating point the pacer picked (capture rate applies at start) */
+static void camera_apply_pacing(void)
+{
+	video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
+
+	frame_pacer_apply();
+
+	if (video_stream_start(video_dev, VIDEO_BUF_TYPE_OUTPUT) < 0) {
+		LOG_ERR("> Failed to restart video stream");
+	}
+}
+#endif
+
+/* Formats the copy path can show; zero-copy sends RGB565 frames as captured */
+static const struct {
+	const char *name;
+	uint32_t pixelformat;
+} camera_pixfmts[] = {
+	{ "rgb565", VIDEO_PIX_FMT_RGB565 },
+	{ "yuyv", VIDEO_PIX_FMT_YUYV },
+};
+
+/* Upper bound for compose and the panel to hand the buffers back */
+#define CAMERA_RECONFIG_TIMEOUT_MS  500
+/* Upper bound for a whole format change, as the shell waits for it */
+#define CAMERA_RECONFIG_REPLY_MS    2000
+
+static const char *camera_pixfmt_name(uint32_t pixelformat)
+{
+	for (int i = 0; i < ARRAY_SIZE(camera_pixfmts); i++) {
+		if (camera_pixfmts[i].pixelformat == pixelformat) {
+			return camera_pixfmts[i].name;
+		}
+	}
+
+	return "?";
+}
+
+/*
+ * Runtime format change: stop the stream, drain compose and the panel so
+ * every buffer is back in the driver, switch the DCMI/sensor format,
+ * reallocate the buffers only if a frame no longer fits, then restart.
+ * A format the sensor rejects, or whose buffers cannot be allocated,
+ * leaves the previous one in place and its error is returned. *fatal is
+ * cleared only once the camera runs again (in either format).
+ */
+static int camera_reconfigure(const struct device *disp, struct video_buffer **vbufs,
+			      size_t count, const struct camera_reconfig_req *req, bool streaming,
+			      bool *fatal)
+{
+	const struct camera_frame drain = { .vbuf = NULL };
+	struct video_format fmt = {
+		.type = VIDEO_BUF_TYPE_OUTPUT,
+		.pixelformat = req->pixelformat,
+		.width = req->width,
+		.height = req->height,
+		.pitch = req->width * sizeof(uint16_t),
+	};
+	int64_t start = k_uptime_get();
+	struct video_buffer *vbuf;
+	size_t frame_size;
+	size_t held = 0;
+	int rejected = 0;
+	int ret;
+
+	*fatal = true;
+
+	if (streaming) {
+		video_stream_stop(video_dev, VIDEO_BUF_TYPE_OUTPUT);
+
+		k_msgq_put(&compose_msgq, &drain, K_FOREVER);
+		if (k_sem_take(&compose_idle_sem, K_MSEC(CAMERA_RECONFIG_TIMEOUT_MS)) != 0) {
+			LOG_ERR("> Compose did not drain");
+			return -ETIMEDOUT;
+		}
+
+		/* Queued and captured buffers alike come out through dequeue */
+		video_stm32u5_dcmi_flush(video_dev);
+		while (video_dequeue(video_dev, &vbuf, K_NO_WAIT) == 0) {
+			held++;
+		}
+		k_poll_signal_reset(&camera_signal);
+
+		if (held != count) {
+			LOG_ERR("> %zu of %zu video buffers returned", held, count);
+			return -EIO;
+		}
+	}
+
+	ret = camera_set_format(&fmt);
+	if (ret < 0) {
+		LOG_WRN("> %s %ux%u rejected: %d", camera_pixfmt_name(req->pixelformat),
+			req->width, req->height, ret);
+		rejected = ret;
+		fmt = camera_fmt;
+		camera_set_format(&fmt);
+	}
+
+	frame_size = fmt.pitch * fmt.height;
+	if (frame_size > vbufs[0]->size) {
+		ret = camera_alloc_buffers(vbufs, count, frame_size);
+		if (ret < 0) {
+			/* Back to the format the old buffers held */
+			rejected = ret;
+			fmt = camera_fmt;
+			camera_set_format(&fmt);
+			frame_size = fmt.pitch * fmt.height;
+			if (camera_alloc_buffers(vbufs, count, frame_size) < 0) {
+				return -ENOMEM;
+			}
+		}
+	}
+
+	camera_fmt = fmt;
+	ret = camera_layout(&camera_fmt);
+	if (ret < 0) {
+		return ret;
+	}
+
+#if CAMERA_ZERO_COPY
+	/* New borders: frames only cover the camera region */
+	camera_clear_display(disp);
+#endif
+
+	if (streaming) {
+		for (int i = 0; i < count; i++) {
+			video_enqueue(video_dev, vbufs[i]);
+		}
+
+		ret = camera_stream_begin();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	*fatal = false;
+	if (rejected < 0) {
+		LOG_WRN("> Camera kept at %s %ux%u", camera_pixfmt_name(fmt.pixelformat),
+			fmt.width, fmt.height);
+		return rejected;
+	}
+
+	LOG_INF("Camera: %s %ux%u, %u byte buffers, in %u ms", camera_pixfmt_name(fmt.pixelformat),
+		fmt.width, fmt.height, (uint32_t)vbufs[0]->size,
+		(uint32_t)(k_uptime_get() - start));
+
+	return 0;
+}
+
+/* Check a format change, hand it to camera_thread and wait for the outcome */
+static int camera_request_format(const struct camera_reconfig_req *req)
+{
+	/* Scaled to the panel, or shown 1:1 */
+	if (req->width < 2 || (req->width % 2) != 0 || req->height < 2 ||
+	    req->width > (CAMERA_SCALING ? FRAME_SCALE_MAX_DIM : DISPLAY_W) ||
+	    req->height > (CAMERA_SCALING ? FRAME_SCALE_MAX_DIM : DISPLAY_H)) {
+		return -EINVAL;
+	}
+
+	if (req->pixelformat != VIDEO_PIX_FMT_RGB565 &&
+	    (CAMERA_ZERO_COPY || req->pixelformat != VIDEO_PIX_FMT_YUYV)) {
+		return -ENOTSUP;
+	}
+
+	if (req->width * req->height * sizeof(uint16_t) > CONFIG_VIDEO_BUFFER_POOL_SZ_MAX) {
+		return -ENOMEM;
+	}
+
+	k_sem_reset(&camera_reconfig_done);
+	if (k_msgq_put(&camera_reconfig_msgq, req, K_NO_WAIT) != 0) {
+		return -EBUSY;
+	}
+
+	/* camera_thread applies it and reports back */
+	if (k_sem_take(&camera_reconfig_done, K_MSEC(CAMERA_RECONFIG_REPLY_MS)) != 0) {
+		return -ETIMEDOUT;
+	}
+
+	return camera_reconfig_ret;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_camera(const struct shell *sh, size_t argc, char **argv)
+{
+	struct camera_reconfig_req req = { .pixelformat = camera_fmt.pixelformat };
+	int ret;
+
+	if (argc == 1) {
+		shell_print(sh, "%s %ux%u shown %ux%u at (%u, %u)",
+			    camera_pixfmt_name(camera_fmt.pixelformat), camera_fmt.width,
+			    camera_fmt.height, frame_w, frame_h, frame_x, frame_y);
+		return 0;
+	}
+
+	if (argc == 2) {
+		shell_error(sh, "Usage: camera [<width> <height> [rgb565|yuyv]]");
+		return -EINVAL;
+	}
+
+	req.width = strtoul(argv[1], NULL, 0);
+	req.height = strtoul(argv[2], NULL, 0);
+	if (argc > 3) {
+		req.pixelformat = 0;
+		for (int i = 0; i < ARRAY_SIZE(camera_pixfmts); i++) {
+			if (strcmp(argv[3], camera_pixfmts[i].name) == 0) {
+				req.pixelformat = camera_pixfmts[i].pixelformat;
+			}
+		}
+	}
+
+	ret = camera_request_format(&req);
+	if (ret < 0) {
+		shell_error(sh, "Format not applied: %d", ret);
+	}
+
+	return ret;
+}
+
+SHELL_CMD_ARG_REGISTER(camera, NULL, "Show or change the capture format "
+		       "[<width> <height> [rgb565|yuyv]]", cmd_camera, 1, 3);
+#endif
+#endif /* !CAMERA_BAND_MODE */
+
+void camera_thread(void)
+{
+	int ret;
+
+	if (!gpio_is_ready_dt(&button)) {
+		LOG_ERR("Button device not ready");
+		return;
+	}
+
+	ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
+	if (ret < 0) {
+		LOG_ERR("Failed to configure button: %d", ret);
+		return;
+	}
+
+	ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_TO_ACTIVE);
+	if (ret < 0) {
+		LOG_ERR("Failed to configure button interrupt: %d", ret);
+		return;
+	}
+
+	gpio_init_callback(&button_cb_data, button_pressed_cb, BIT(button.pin));
+	gpio_add_callback(button.port, &button_cb_data);
+
+    LOG_INF("===== Camera Config Info =====");
+
+	/* Get display device for writing the captured frame */
+	const struct device *disp = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+	if (!device_is_ready(disp)) {
+		LOG_ERR("> Display device not ready in camera thread");
+		return;
+	}
+
+	ret = camera_layout(&camera_fmt);
+	if (ret < 0) {
+		return;
+	}
+
+	/* Allocate video buffers from the video buffer pool */
+	size_t frame_size = camera_fmt.pitch * camera_fmt.height;
+	struct video_buffer *vbufs[CONFIG_VIDEO_BUFFER_POOL_NUM_MAX] = { NULL };
+
+	if (camera_alloc_buffers(vbufs, ARRAY_SIZE(vbufs), frame_size) < 0) {
+		return;
+	}
+
+#if CAMERA_ZERO_COPY
+	/* Frames go to the panel from the video buffers: only clear the borders */
+	ret = camera_clear_display(disp);
+	if (ret < 0) {
+		LOG_ERR("> Failed to clear display: %d", ret);
+		return;
+	}
+
+	ret = display_async_init(disp, NULL, 0, camera_frame_shown, NULL);
+	if (ret < 0) {
+		LOG_ERR("> Failed to start display output: %d", ret);
+		return;
+	}
+#else
+	/* Allocate output buffers: full display width so borders are included */
+	uint8_t *disp_bufs[CAMERA_DISP_BUFS];
+
+	for (int i = 0; i < ARRAY_SIZE(disp_bufs); i++) {
+		disp_bufs[i] = k_malloc(DISPLAY_W * DISPLAY_H * sizeof(uint16_t));
+		if (disp_bufs[i] == NULL) {
+			LOG_ERR("> Failed to allocate camera display buffer %d", i);
+			return;
+		}
+		/* Black borders; the camera region is overwritten by every frame */
+		memset(disp_bufs[i], 0x00, DISPLAY_W * DISPLAY_H * sizeof(uint16_t));
+	}
+
+#if !CAMERA_BAND_MODE
+	ret = display_async_init(disp, disp_bufs, ARRAY_SIZE(disp_bufs), camera_frame_shown, NULL);
+	if (ret < 0) {
+		LOG_ERR("> Failed to start display output: %d", ret);
+		return;
+	}
+#endif
+#endif /* CAMERA_ZERO_COPY */
+
+#if CAMERA_STREAM
+	/* Optional: the camera runs without it */
+	ret = frame_stream_init(DEVICE_DT_GET(DT_CHOSEN(app_frame_stream)),
+				CONFIG_APP_FRAME_STREAM_DECIMATION, camera_tap_done, NULL);
+	if (ret < 0) {
+		LOG_WRN("> Frame streaming not started: %d", ret);
+	}
+#endif
+
+#if CAMERA_RECORD
+	ret = frame_record_init(FIXED_PARTITION_ID(frame_record_partition),
+				CONFIG_APP_FRAME_RECORD_PERIOD_MS, camera_tap_done, NULL);
+	if (ret < 0) {
+		LOG_WRN("> Frame recording not started: %d", ret);
+	}
+#endif
+
+	/* Log the format the DCMI driver actually stored */
+	struct video_format active_fmt = { .type = VIDEO_BUF_TYPE_OUTPUT };
+
+	video_get_format(video_dev, &active_fmt);
+	LOG_INF("DCMI fmt: %ux%u pitch=%u pixfmt=0x%08x",
+		active_fmt.width, active_fmt.height,
+		active_fmt.pitch, active_fmt.pixelformat);
+	LOG_INF("Vbuf size=%u, buf[0]=%p",
+		(uint32_t)frame_size, (void *)vbufs[0]->buffer);
+
+	LOG_INF("Streaming in %s mode\n",
+		CAMERA_CAPTURE_MODE_CONTINUOUS ? "continuous" : "snapshot");
+
+	ret = video_set_signal(video_dev, &camera_signal);
+	if (ret < 0) {
+		LOG_ERR("> Failed to set video signal: %d", ret);
+		return;
+	}
+
+	/*
+	 * One wait for everything: frame ready (video signal), SW0 press,
+	 * inference done and format change requests. Nothing wakes this
+	 * thread on a timeout.
+	 */
+	struct k_poll_event events[] = {
+		[CAMERA_EVT_FRAME] = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+							      K_POLL_MODE_NOTIFY_ONLY,
+							      &camera_signal),
+		[CAMERA_EVT_BUTTON] = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE,
+							       K_POLL_MODE_NOTIFY_ONLY,
+							       &capture_sem),
+		[CAMERA_EVT_INFERENCE] = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE,
+								  K_POLL_MODE_NOTIFY_ONLY,
+								  &inference_done_sem),
+		[CAMERA_EVT_RECONFIG] = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+								 K_POLL_MODE_NOTIFY_ONLY,
+								 &camera_reconfig_msgq),
+	};
+	bool capturing = false;
+
+	while (1) {
+		k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+
+		/* SW0 starts the capture (it then runs until power cycle), then dumps latencies */
+		if (events[CAMERA_EVT_BUTTON].state == K_POLL_STATE_SEM_AVAILABLE) {
+			k_sem_take(&capture_sem, K_NO_WAIT);
+			if (!capturing) {
+				if (camera_capture_start(vbufs, ARRAY_SIZE(vbufs)) < 0) {
+					return;
+				}
+				capturing = true;
+#if CAMERA_BAND_MODE
+				camera_band_loop(disp, disp_bufs[0]);
+#endif
+			} else {
+#if !CAMERA_BAND_MODE
+				/* Later presses dump (and restart) the stage latencies */
+				camera_latency_dump(NULL, true);
+#endif
+			}
+		}
+
+		if (events[CAMERA_EVT_INFERENCE].state == K_POLL_STATE_SEM_AVAILABLE) {
+			k_sem_take(&inference_done_sem, K_NO_WAIT);
+			LOG_INF("Overlay ready");
+		}
+
+#if !CAMERA_BAND_MODE
+		if (events[CAMERA_EVT_RECONFIG].state == K_POLL_STATE_MSGQ_DATA_AVAILABLE) {
+			struct camera_reconfig_req req;
+			bool fatal;
+
+			k_msgq_get(&camera_reconfig_msgq, &req, K_NO_WAIT);
+			camera_reconfig_ret = camera_reconfigure(disp, vbufs, ARRAY_SIZE(vbufs),
+								 &req, capturing, &fatal);
+			k_sem_give(&camera_reconfig_done);
+			if (fatal) {
+				LOG_ERR("> Camera reconfiguration failed");
+				return;
+			}
+		}
+
+		if (events[CAMERA_EVT_FRAME].state == K_POLL_STATE_SIGNALED) {
+			camera_frames_ready();
+			fps_report();
+#if CAMERA_PACING
+			if (frame_pacer_update()) {
+				camera_apply_pacing();
+			}
+#endif
+		}
+#endif
+
+		for (int i = 0; i < ARRAY_SIZE(events); i++) {
+			events[i].state = K_POLL_STATE_NOT_READY;
+		}
+	}
+}
+
+
+void display_thread(void)
+{
+	size_t rect_w;
+	size_t rect_h;
+	size_t h_step;
+	size_t scale;
+	uint8_t *buf;
+	int32_t grey_scale_sleep;
+	const struct device *display_dev;
+	struct display_capabilities capabilities;
+	struct display_buffer_descriptor buf_desc;
+	size_t buf_size = 0;
+
+	display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+	if (!device_is_ready(display_dev)) {
+		LOG_ERR("Device %s not found. Aborting sample.",
+			display_dev->name);
+		return;
+	}
+
+	// LOG_INF("Display %s Thread Starts", display_dev->name);
+	display_get_capabilities(display_dev, &capabilities);
+
+	if (capabilities.screen_info & SCREEN_INFO_MONO_VTILED) {
+		rect_w = 16;
+		rect_h = 8;
+	} else {
+		rect_w = 2;
+		rect_h = 1;
+	}
+
+	if ((capabilities.x_resolution < 3 * rect_w) ||
+	    (capabilities.y_resolution < 3 * rect_h) ||
+	    (capabilities.x_resolution < 8 * rect_h)) {
+		rect_w = capabilities.x_resolution * 40 / 100;
+		rect_h = capabilities.y_resolution * 40 / 100;
+		h_step = capabilities.y_resolution * 20 / 100;
+		scale = 1;
+	} else {
+		h_step = rect_h;
+		scale = (capabilities.x_resolution / 8) / rect_h;
+	}
+
+	rect_w *= scale;
 	rect_h *= scale;
 
 	if (capabilities.screen_info & SCREEN_INFO_EPD) {
@@ -968,10 +2461,12 @@ int main(void)
 	LOG_INF("==============================\n");
 
 	/* Init camera sensor + video capture (DCMI) device */
+#if CAMERA_HAS_OV5640
 	if (!device_is_ready(ov5640)) {
 		LOG_INF("> OV5640 camera sensor not ready");
 		return -ENODEV;
 	}
+#endif
 
 	if (!device_is_ready(video_dev)) {
 		LOG_INF("> Video capture device (DCMI) not ready");
@@ -980,75 +2475,25 @@ int main(void)
 
 	// LOG_INF("Camera + DCMI ready");
 
-	struct video_format fmt = {
-		.type = VIDEO_BUF_TYPE_OUTPUT,
-		.pixelformat = VIDEO_PIX_FMT_RGB565,
-		.width = CAMERA_W,
-		.height = CAMERA_H,
-		.pitch = CAMERA_W * sizeof(uint16_t),
-	};
+	struct video_format fmt = camera_fmt;
 
-	if (video_set_format(video_dev, &fmt)) {
+	if (camera_set_format(&fmt)) {
 		LOG_ERR("> Failed to set camera format");
 		return -EIO;
 	}
 
-	/*
-	 * Override OV5640 FORMAT CONTROL 00 (0x4300) to 0x61 (RGB565 2X8 BE) so
-	 * the sensor output matches the display byte order and no per-pixel
-	 * swap is needed. Done here so we don't have to patch the Zephyr driver.
-	 */
-	{
-		const struct device *i2c_dev = DEVICE_DT_GET(DT_PARENT(DT_NODELABEL(ov5640)));
-		uint8_t ov5640_addr = DT_REG_ADDR(DT_NODELABEL(ov5640));
-		uint8_t fmt_ctrl[] = { 0x43, 0x00, 0x61 }; /* 0x4300 = 0x61 */
-
-		if (device_is_ready(i2c_dev)) {
-			int ret = i2c_write(i2c_dev, fmt_ctrl, sizeof(fmt_ctrl), ov5640_addr);
-			if (ret != 0) 
-			{
-				LOG_WRN("> OV5640 0x4300 override failed: %d (colors may be wrong)", ret);
-			}
-			// else 
-			// {
-			// 	LOG_INF("> OV5640 0x4300 set to 0x61 (RGB565 BE)");
-			// }
-		} else {
-			LOG_WRN("> OV5640 I2C bus not ready, skip 0x4300 override");
-		}
-	}
-
-	/*
-	 * Flip controls: video_set_ctrl skips the driver when new value equals
-	 * current (default 0). Resolution params set 0x3820/0x3821, so we must
-	 * force a write by setting the opposite value first.
-	 */
-	struct video_control ctrl;
-	int want_hflip = 0, want_vflip = 0;
-
-	ctrl.id = VIDEO_CID_HFLIP;
-	ctrl.val = 1;
-	video_set_ctrl(ov5640, &ctrl);
-	ctrl.val = want_hflip;
-	if (video_set_ctrl(ov5640, &ctrl)) {
-		LOG_ERR("> Failed to set HFLIP");
-	}
-
-	ctrl.id = VIDEO_CID_VFLIP;
-	ctrl.val = 1;
-	video_set_ctrl(ov5640, &ctrl);
-	ctrl.val = want_vflip;
-	if (video_set_ctrl(ov5640, &ctrl)) {
-		LOG_ERR("> Failed to set VFLIP");
-	}
-
-	LOG_INF("Camera configured: RGB565 %ux%u (hflip=%d vflip=%d)\n", CAMERA_W, CAMERA_H,
-		want_hflip, want_vflip);
+	LOG_INF("Camera configured: RGB565 %ux%u (hflip=%d vflip=%d)\n", fmt.width, fmt.height,
+		CAMERA_HFLIP, CAMERA_VFLIP);
 
 	/* TFLM overlay is filled by inference thread; no setup here */
 
 	// LOG_INF("====== Threads STARTING ======");
+#if CAMERA_HAS_OV5640
 	LOG_INF("Press Button 2 to start capture...\n");
+#else
+	/* Emulated camera: nobody to press SW0 */
+	k_sem_give(&capture_sem);
+#endif
 
 	return 0;
 }
@@ -1062,6 +2507,7 @@ static void inference_thread(void)
 		tflm_sine_fill_overlay_buffer();
 	// 	k_msleep(1000);
 	// }
+	k_sem_give(&inference_done_sem);
 }
 
 K_THREAD_DEFINE(inference_id, INFERENCE_STACKSIZE, inference_thread, NULL, NULL, NULL,
@@ -1074,3 +2520,7 @@ K_THREAD_DEFINE(blink1_id, DEFAULT_STACKSIZE, blink1, NULL, NULL, NULL,
 		PRIORITY_LED, 0, 0);
 K_THREAD_DEFINE(camera_id, CAMERA_STACKSIZE, camera_thread, NULL, NULL, NULL,
 		PRIORITY_CAMERA, 0, 0);
+#if !CAMERA_BAND_MODE
+K_THREAD_DEFINE(compose_id, COMPOSE_STACKSIZE, compose_thread, NULL, NULL, NULL,
+		PRIORITY_CAMERA, 0, 0);
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Tile-level change detection for partial display updates (see tile_diff.h).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "tile_diff.h"
+
+#include <errno.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#define TILE_DIFF_FNV_OFFSET 2166136261u
+#define TILE_DIFF_FNV_PRIME  16777619u
+
+int tile_diff_init(struct tile_diff *td, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+		   uint16_t pitch)
+{
+	uint16_t cols = DIV_ROUND_UP(w, TILE_DIFF_W);
+	uint16_t rows = DIV_ROUND_UP(h, TILE_DIFF_H);
+
+	if (w == 0 || h == 0 || x + w > pitch || cols * rows > TILE_DIFF_MAX_TILES) {
+		return -EINVAL;
+	}
+
+	td->x = x;
+	td->y = y;
+	td->w = w;
+	td->h = h;
+	td->pitch = pitch;
+	td->cols = cols;
+	td->rows = rows;
+	td->valid = false;
+
+	return 0;
+}
+
+void tile_diff_invalidate(struct tile_diff *td)
+{
+	td->valid = false;
+}
+
+/* FNV-1a over the masked pixels of one tile, a pixel at a time */
+static uint32_t tile_diff_hash(const struct tile_diff *td, const uint16_t *frame,
+			       uint16_t px, uint16_t py, uint16_t tw, uint16_t th)
+{
+	/* Same mask whatever the CPU byte order: pixels are stored big-endian */
+	const uint16_t mask = sys_cpu_to_be16(TILE_DIFF_PIXEL_MASK);
+	uint32_t hash = TILE_DIFF_FNV_OFFSET;
+
+	for (uint16_t y = 0; y < th; y++) {
+		const uint16_t *row = frame + (py + y) * td->pitch + px;
+
+		for (uint16_t x = 0; x < tw; x++) {
+			hash = (hash ^ (row[x] & mask)) * TILE_DIFF_FNV_PRIME;
+		}
+	}
+
+	return hash;
+}
+
+size_t tile_diff_update(struct tile_diff *td, const uint8_t *frame,
+			struct display_async_rect *rects, size_t max_rects)
+{
+	/* Rectangles in tile units while merging: columns [c0, c1), rows [r0, r1) */
+	struct {
+		uint16_t c0, c1, r0, r1;
+	} merged[DISPLAY_ASYNC_MAX_RECTS];
+	uint16_t bb_c0 = UINT16_MAX, bb_c1 = 0, bb_r0 = UINT16_MAX, bb_r1 = 0;
+	size_t num = 0;
+	bool overflow = false;
+
+	max_rects = MIN(max_rects, ARRAY_SIZE(merged));
+
+	for (uint16_t r = 0; r < td->rows; r++) {
+		uint16_t py = td->y + r * TILE_DIFF_H;
+		uint16_t th = MIN(TILE_DIFF_H, td->y + td->h - py);
+		uint16_t run = UINT16_MAX;
+
+		/* One pass past the last column closes a run that reaches the edge */
+		for (uint16_t c = 0; c <= td->cols; c++) {
+			bool dirty = false;
+
+			if (c < td->cols) {
+				uint16_t px = td->x + c * TILE_DIFF_W;
+				uint16_t tw = MIN(TILE_DIFF_W, td->x + td->w - px);
+				uint32_t *hash = &td->hash[r * td->cols + c];
+				uint32_t h = tile_diff_hash(td, (const uint16_t *)frame, px, py,
+							    tw, th);
+
+				dirty = !td->valid || h != *hash;
+				*hash = h;
+			}
+
+			if (dirty) {
+				if (run == UINT16_MAX) {
+					run = c;
+				}
+				continue;
+			}
+
+			if (run == UINT16_MAX) {
+				continue;
+			}
+
+			/* Dirty run [run, c) on row r */
+			bb_c0 = MIN(bb_c0, run);
+			bb_c1 = MAX(bb_c1, c);
+			bb_r0 = MIN(bb_r0, r);
+			bb_r1 = r + 1;
+
+			size_t i;
+
+			/* Grow the rectangle right above when it spans the same columns */
+			for (i = 0; i < num; i++) {
+				if (merged[i].c0 == run && merged[i].c1 == c && merged[i].r1 == r) {
+					merged[i].r1++;
+					break;
+				}
+			}
+
+			if (i == num) {
+				if (num < max_rects) {
+					merged[num].c0 = run;
+					merged[num].c1 = c;
+					merged[num].r0 = r;
+					merged[num].r1 = r + 1;
+					num++;
+				} else {
+					overflow = true;
+				}
+			}
+
+			run = UINT16_MAX;
+		}
+	}
+
+	td->valid = true;
+
+	if (bb_r1 == 0) {
+		return 0;
+	}
+
+	if (overflow) {
+		merged[0].c0 = bb_c0;
+		merged[0].c1 = bb_c1;
+		merged[0].r0 = bb_r0;
+		merged[0].r1 = bb_r1;
+		num = 1;
+	}
+
+	for (size_t i = 0; i < num; i++) {
+		uint16_t x0 = merged[i].c0 * TILE_DIFF_W;
+		uint16_t y0 = merged[i].r0 * TILE_DIFF_H;
+
+		rects[i].x = td->x + x0;
+		rects[i].y = td->y + y0;
+		rects[i].w = MIN(merged[i].c1 * TILE_DIFF_W, td->w) - x0;
+		rects[i].h = MIN(merged[i].r1 * TILE_DIFF_H, td->h) - y0;
+	}
+
+	return num;
+}
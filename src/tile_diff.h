@@ -0,0 +1,83 @@
+/*
+ * Tile-level change detection for partial display updates.
+ *
+ * A region of an RGB565 frame is split into TILE_DIFF_W x TILE_DIFF_H tiles
+ * and each tile is hashed. Tiles whose hash differs from the previous call
+ * are dirty; neighbouring dirty tiles are merged into as few rectangles as
+ * possible, ready for display_async_submit_rects().
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TILE_DIFF_H_
+#define TILE_DIFF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "display_async.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILE_DIFF_W          16
+#define TILE_DIFF_H          8
+/* Enough for a 240x135 region */
+#define TILE_DIFF_MAX_TILES  256
+
+/*
+ * RGB565 bits (panel byte order, big-endian) that take part in the hash:
+ * the LSB of red and blue and two of green are left out so that sensor
+ * noise alone does not mark a static tile dirty.
+ */
+#define TILE_DIFF_PIXEL_MASK 0xF79E
+
+struct tile_diff {
+	/* Region in the frame, in pixels */
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+	/* Frame pitch in pixels */
+	uint16_t pitch;
+	uint16_t cols;
+	uint16_t rows;
+	/* Hashes match what the panel shows */
+	bool valid;
+	uint32_t hash[TILE_DIFF_MAX_TILES];
+};
+
+/**
+ * Set up change detection over a region of an RGB565 frame. All tiles
+ * start dirty.
+ *
+ * @retval 0 on success, -EINVAL if the region needs more than
+ *         TILE_DIFF_MAX_TILES tiles or does not fit in the pitch
+ */
+int tile_diff_init(struct tile_diff *td, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+		   uint16_t pitch);
+
+/* Mark every tile dirty, e.g. after something else drew over the region. */
+void tile_diff_invalidate(struct tile_diff *td);
+
+/**
+ * Hash the region of frame, remember the hashes and list what changed.
+ * Rectangles are in frame pixels and never overlap. When the changes do
+ * not fit in max_rects, a single bounding rectangle is returned.
+ *
+ * @param td        Change detection state
+ * @param frame     Frame the region lives in (pitch as given at init)
+ * @param rects     Filled with the changed rectangles
+ * @param max_rects Capacity of rects (at least 1)
+ * @retval Number of rectangles, 0 when nothing changed
+ */
+size_t tile_diff_update(struct tile_diff *td, const uint8_t *frame,
+			struct display_async_rect *rects, size_t max_rects);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TILE_DIFF_H_ */
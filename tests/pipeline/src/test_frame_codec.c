@@ -0,0 +1,189 @@
+/*
+ * frame_codec: encode, then decode with a port of the decoder in
+ * scripts/frame_stream_rx.py, and compare with the source frame.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "frame_codec.h"
+
+#define W     24
+#define H     10
+#define PITCH 32
+
+static uint16_t frame[H * PITCH];
+static uint16_t decoded[W * H];
+static uint8_t out[W * H * sizeof(uint16_t)];
+
+static uint16_t px_hash(uint16_t px)
+{
+	return ((px >> 11) * 3 + ((px >> 5) & 0x3F) * 5 + (px & 0x1F) * 7) % 64;
+}
+
+static uint16_t px_add(uint16_t px, int dr, int dg, int db)
+{
+	return (((px >> 11) + dr) & 0x1F) << 11 | ((((px >> 5) & 0x3F) + dg) & 0x3F) << 5 |
+	       (((px & 0x1F) + db) & 0x1F);
+}
+
+/* Decoded pixels in CPU order; returns the number of pixels, or -EINVAL */
+static int qoi565_decode(const uint8_t *data, size_t len, uint16_t *px_out, size_t count)
+{
+	uint16_t index[64] = { 0 };
+	uint16_t prev = 0;
+	size_t i = 0;
+	size_t n = 0;
+
+	while (n < count && i < len) {
+		const uint8_t op = data[i++];
+		uint16_t px;
+
+		if (op == 0xFE) {
+			px = data[i] << 8 | data[i + 1];
+			i += 2;
+		} else if (op >= 0xC0) {
+			for (int r = 0; r <= (op & 0x3F) && n < count; r++) {
+				px_out[n++] = prev;
+			}
+			continue;
+		} else if (op >= 0x80) {
+			const int dg = (op & 0x3F) - 32;
+
+			px = px_add(prev, (data[i] >> 4) - 8 + dg, dg, (data[i] & 0x0F) - 8 + dg);
+			i++;
+		} else if (op >= 0x40) {
+			px = px_add(prev, ((op >> 4) & 3) - 2, ((op >> 2) & 3) - 2, (op & 3) - 2);
+		} else {
+			px = index[op];
+		}
+		index[px_hash(px)] = px;
+		px_out[n++] = px;
+		prev = px;
+	}
+
+	return n == count && i == len ? (int)n : -EINVAL;
+}
+
+static void check_decoded(int len, enum frame_codec codec)
+{
+	zassert_true(len > 0, "encode failed: %d", len);
+
+	if (codec == FRAME_CODEC_RAW) {
+		zassert_equal(len, W * H * sizeof(uint16_t));
+		for (int y = 0; y < H; y++) {
+			zassert_mem_equal(&out[y * W * sizeof(uint16_t)], &frame[y * PITCH],
+					  W * sizeof(uint16_t), "row %d", y);
+		}
+		return;
+	}
+
+	zassert_equal(qoi565_decode(out, len, decoded, W * H), W * H);
+	for (int y = 0; y < H; y++) {
+		for (int x = 0; x < W; x++) {
+			zassert_equal(decoded[y * W + x], sys_be16_to_cpu(frame[y * PITCH + x]),
+				      "pixel %d,%d", x, y);
+		}
+	}
+}
+
+static void fill(uint16_t (*px)(int x, int y))
+{
+	for (int y = 0; y < H; y++) {
+		for (int x = 0; x < PITCH; x++) {
+			/* Columns past W must not end up in the output */
+			frame[y * PITCH + x] = sys_cpu_to_be16(x < W ? px(x, y) : 0xDEAD);
+		}
+	}
+}
+
+/* Flat bands, a gradient and a few far jumps: runs, diffs, index and raw ops */
+static uint16_t px_mixed(int x, int y)
+{
+	if (y < 3) {
+		return 0x1234;
+	}
+	if (y < 6) {
+		return (x / 2) << 11 | (x + y) << 5 | (31 - x / 2);
+	}
+
+	return (x % 3 == 0) ? 0xF800 : (x % 3 == 1) ? 0x07E0 : (uint16_t)(x * 2749 + y * 40503);
+}
+
+static uint32_t noise_state;
+
+static uint16_t px_noise(int x, int y)
+{
+	ARG_UNUSED(x);
+	ARG_UNUSED(y);
+
+	noise_state ^= noise_state << 13;
+	noise_state ^= noise_state >> 17;
+	noise_state ^= noise_state << 5;
+
+	return noise_state;
+}
+
+ZTEST(frame_codec, test_round_trip)
+{
+	enum frame_codec codec;
+	int len;
+
+	fill(px_mixed);
+	len = frame_codec_encode((const uint8_t *)frame, W, H, PITCH, out, sizeof(out), &codec);
+
+	zassert_equal(codec, FRAME_CODEC_QOI565);
+	check_decoded(len, codec);
+}
+
+static uint16_t px_flat(int x, int y)
+{
+	ARG_UNUSED(x);
+	ARG_UNUSED(y);
+
+	return 0x1234;
+}
+
+ZTEST(frame_codec, test_flat)
+{
+	enum frame_codec codec;
+	int len;
+
+	fill(px_flat);
+	len = frame_codec_encode((const uint8_t *)frame, W, H, PITCH, out, sizeof(out), &codec);
+
+	/* One raw pixel, then runs of at most 62 */
+	zassert_equal(codec, FRAME_CODEC_QOI565);
+	zassert_equal(len, 3 + DIV_ROUND_UP(W * H - 1, 62));
+	check_decoded(len, codec);
+}
+
+ZTEST(frame_codec, test_noise_is_raw)
+{
+	enum frame_codec codec;
+	int len;
+
+	noise_state = 2463534242u;
+	fill(px_noise);
+	len = frame_codec_encode((const uint8_t *)frame, W, H, PITCH, out, sizeof(out), &codec);
+
+	zassert_equal(codec, FRAME_CODEC_RAW);
+	check_decoded(len, codec);
+}
+
+ZTEST(frame_codec, test_no_space)
+{
+	enum frame_codec codec;
+
+	noise_state = 2463534242u;
+	fill(px_noise);
+
+	zassert_equal(frame_codec_encode((const uint8_t *)frame, W, H, PITCH, out,
+					 sizeof(out) - 1, &codec), -ENOSPC);
+}
+
+ZTEST_SUITE(frame_codec, NULL, NULL, NULL, NULL, NULL);
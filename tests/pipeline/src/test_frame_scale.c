@@ -0,0 +1,158 @@
+/*
+ * frame_scale: orientations at 1:1 with the nearest filter, where every
+ * destination pixel is one known source pixel, then scaling.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <zephyr/ztest.h>
+
+#include "frame_scale.h"
+
+#define SRC_W 20
+#define SRC_H 6
+
+static struct frame_scale fs;
+static uint16_t src[SRC_H * SRC_W] __aligned(4);
+/* Fits the source in either orientation, plus one odd column */
+static uint16_t dst[SRC_W * (SRC_W + 1)] __aligned(4);
+
+/* Pixel value = source position, so a destination pixel names its source */
+static void fill_src(void)
+{
+	for (int y = 0; y < SRC_H; y++) {
+		for (int x = 0; x < SRC_W; x++) {
+			src[y * SRC_W + x] = y << 8 | x;
+		}
+	}
+}
+
+static void check_orient(uint8_t orient)
+{
+	const bool transpose = (orient & FRAME_SCALE_TRANSPOSE) != 0;
+	const uint16_t dw = transpose ? SRC_H : SRC_W;
+	const uint16_t dh = transpose ? SRC_W : SRC_H;
+	/* Odd pitch: rows alternate between aligned and unaligned stores */
+	const uint16_t pitch = dw + 1;
+
+	fill_src();
+	zassert_ok(frame_scale_init(&fs, SRC_W, SRC_H, dw, dh, FRAME_SCALE_NEAREST, orient));
+	frame_scale_rows(&fs, (const uint8_t *)src, SRC_W * sizeof(uint16_t), (uint8_t *)dst,
+			 pitch * sizeof(uint16_t), 0, dh);
+
+	for (int y = 0; y < dh; y++) {
+		for (int x = 0; x < dw; x++) {
+			/* Destination x/y along source columns/rows, before mirroring */
+			int sx = transpose ? y : x;
+			int sy = transpose ? x : y;
+
+			if ((orient & FRAME_SCALE_MIRROR_X) != 0) {
+				if (transpose) {
+					sy = SRC_H - 1 - sy;
+				} else {
+					sx = SRC_W - 1 - sx;
+				}
+			}
+			if ((orient & FRAME_SCALE_MIRROR_Y) != 0) {
+				if (transpose) {
+					sx = SRC_W - 1 - sx;
+				} else {
+					sy = SRC_H - 1 - sy;
+				}
+			}
+
+			zassert_equal(dst[y * pitch + x], sy << 8 | sx,
+				      "orient %u pixel %d,%d: %04x", orient, x, y,
+				      dst[y * pitch + x]);
+		}
+	}
+}
+
+ZTEST(frame_scale, test_rotate_0)
+{
+	check_orient(FRAME_SCALE_ROTATE_0);
+}
+
+ZTEST(frame_scale, test_mirror)
+{
+	check_orient(FRAME_SCALE_MIRROR_X);
+	check_orient(FRAME_SCALE_MIRROR_Y);
+}
+
+ZTEST(frame_scale, test_rotate_90)
+{
+	check_orient(FRAME_SCALE_ROTATE_90);
+
+	/* Clockwise: the bottom-left source pixel ends up top-left */
+	zassert_equal(dst[0], (SRC_H - 1) << 8 | 0);
+}
+
+ZTEST(frame_scale, test_rotate_180)
+{
+	check_orient(FRAME_SCALE_ROTATE_180);
+}
+
+ZTEST(frame_scale, test_rotate_270)
+{
+	check_orient(FRAME_SCALE_ROTATE_270);
+
+	/* Counter-clockwise: the top-right source pixel ends up top-left */
+	zassert_equal(dst[0], 0 << 8 | (SRC_W - 1));
+}
+
+ZTEST(frame_scale, test_rotate_mirrored)
+{
+	check_orient(FRAME_SCALE_ROTATE_90 ^ FRAME_SCALE_MIRROR_X);
+	check_orient(FRAME_SCALE_ROTATE_270 ^ FRAME_SCALE_MIRROR_X);
+}
+
+ZTEST(frame_scale, test_half_size)
+{
+	fill_src();
+	zassert_ok(frame_scale_init(&fs, SRC_W, SRC_H, SRC_W / 2, SRC_H / 2,
+				    FRAME_SCALE_NEAREST, FRAME_SCALE_ROTATE_0));
+	frame_scale_rows(&fs, (const uint8_t *)src, SRC_W * sizeof(uint16_t), (uint8_t *)dst,
+			 SRC_W / 2 * sizeof(uint16_t), 0, SRC_H / 2);
+
+	/* Centres aligned: every other source pixel, starting from the second */
+	for (int y = 0; y < SRC_H / 2; y++) {
+		for (int x = 0; x < SRC_W / 2; x++) {
+			zassert_equal(dst[y * SRC_W / 2 + x], (2 * y + 1) << 8 | (2 * x + 1));
+		}
+	}
+}
+
+ZTEST(frame_scale, test_bilinear_flat)
+{
+	/* Any blend of one colour is that colour */
+	for (size_t i = 0; i < ARRAY_SIZE(src); i++) {
+		src[i] = 0x5AA5;
+	}
+
+	zassert_ok(frame_scale_init(&fs, SRC_W, SRC_H, 15, 9, FRAME_SCALE_BILINEAR,
+				    FRAME_SCALE_ROTATE_0));
+	frame_scale_rows(&fs, (const uint8_t *)src, SRC_W * sizeof(uint16_t), (uint8_t *)dst,
+			 15 * sizeof(uint16_t), 0, 9);
+	for (int i = 0; i < 15 * 9; i++) {
+		zassert_equal(dst[i], 0x5AA5, "pixel %d", i);
+	}
+
+	zassert_ok(frame_scale_init(&fs, SRC_W, SRC_H, 9, 15, FRAME_SCALE_BILINEAR,
+				    FRAME_SCALE_ROTATE_90));
+	frame_scale_rows(&fs, (const uint8_t *)src, SRC_W * sizeof(uint16_t), (uint8_t *)dst,
+			 9 * sizeof(uint16_t), 0, 15);
+	for (int i = 0; i < 9 * 15; i++) {
+		zassert_equal(dst[i], 0x5AA5, "pixel %d", i);
+	}
+}
+
+ZTEST(frame_scale, test_bad_size)
+{
+	zassert_equal(frame_scale_init(&fs, 0, SRC_H, SRC_W, SRC_H, FRAME_SCALE_NEAREST, 0),
+		      -EINVAL);
+	zassert_equal(frame_scale_init(&fs, SRC_W, SRC_H, FRAME_SCALE_MAX_DIM + 1, SRC_H,
+				       FRAME_SCALE_NEAREST, 0), -EINVAL);
+}
+
+ZTEST_SUITE(frame_scale, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,99 @@
+/*
+ * latency_hist: bucket edges and the min/avg/p99/max summary.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include "latency_hist.h"
+
+static struct latency_hist hist;
+
+static void latency_hist_before(void *fixture)
+{
+	struct latency_hist_summary s;
+
+	ARG_UNUSED(fixture);
+
+	latency_hist_summarize(&hist, &s, true);
+}
+
+/* Bucket a sample lands in, from the bucket floors */
+static size_t bucket_of(uint32_t cycles)
+{
+	size_t i = 0;
+
+	while (i + 1 < LATENCY_HIST_BUCKETS && latency_hist_bucket_floor(i + 1) <= cycles) {
+		i++;
+	}
+
+	return i;
+}
+
+ZTEST(latency_hist, test_bucket_floor)
+{
+	/* Exact below 4, then 4 per power of two */
+	for (uint32_t i = 0; i < 8; i++) {
+		zassert_equal(latency_hist_bucket_floor(i), i);
+	}
+	zassert_equal(latency_hist_bucket_floor(9), 10);
+	zassert_equal(latency_hist_bucket_floor(12), 16);
+	zassert_equal(latency_hist_bucket_floor(LATENCY_HIST_BUCKETS - 1), 7U << 29);
+
+	/* Floors grow, and no bucket is wider than a quarter of its floor */
+	for (size_t i = 5; i < LATENCY_HIST_BUCKETS; i++) {
+		uint32_t lo = latency_hist_bucket_floor(i - 1);
+		uint32_t hi = latency_hist_bucket_floor(i);
+
+		zassert_true(hi > lo);
+		zassert_true(hi - lo <= lo / 4, "bucket %zu: %u..%u", i - 1, lo, hi);
+	}
+}
+
+ZTEST(latency_hist, test_empty)
+{
+	struct latency_hist_summary s;
+
+	latency_hist_summarize(&hist, &s, false);
+	zassert_equal(s.count, 0);
+	zassert_equal(s.max_us, 0);
+}
+
+ZTEST(latency_hist, test_summary)
+{
+	const uint32_t fast = sys_clock_hw_cycles_per_sec() / 1000;
+	const uint32_t slow = 50 * fast;
+	uint32_t buckets[LATENCY_HIST_BUCKETS];
+	struct latency_hist_summary s;
+	uint32_t total = 0;
+
+	/* 990 samples at 1 ms and 10 at 50 ms: the p99 is still the fast bucket */
+	for (int i = 0; i < 990; i++) {
+		latency_hist_record(&hist, fast);
+	}
+	for (int i = 0; i < 10; i++) {
+		latency_hist_record(&hist, slow);
+	}
+
+	latency_hist_buckets(&hist, buckets);
+	for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+		total += buckets[i];
+	}
+	zassert_equal(buckets[bucket_of(fast)], 990);
+	zassert_equal(buckets[bucket_of(slow)], 10);
+	zassert_equal(total, 1000);
+
+	latency_hist_summarize(&hist, &s, true);
+	zassert_equal(s.count, 1000);
+	zassert_equal(s.min_us, 1000);
+	zassert_equal(s.max_us, 50000);
+	zassert_equal(s.avg_us, k_cyc_to_us_floor32((990ULL * fast + 10ULL * slow) / 1000));
+	zassert_true(s.p99_us >= 1000 && s.p99_us <= 1250, "p99 %u", s.p99_us);
+
+	/* Reset */
+	latency_hist_summarize(&hist, &s, false);
+	zassert_equal(s.count, 0);
+}
+
+ZTEST_SUITE(latency_hist, NULL, NULL, latency_hist_before, NULL, NULL);
@@ -0,0 +1,99 @@
+/*
+ * tile_diff: what a frame update reports after init, no change, a change
+ * in one tile, a change below the noise mask and an invalidate.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "tile_diff.h"
+
+/* 3 x 3 tiles, the last column and row partial, away from the frame edges */
+#define PITCH 64
+#define RX    4
+#define RY    2
+#define RW    (2 * TILE_DIFF_W + 5)
+#define RH    (2 * TILE_DIFF_H + 3)
+
+static struct tile_diff td;
+static uint16_t frame[(RY + RH + 2) * PITCH];
+static struct display_async_rect rects[DISPLAY_ASYNC_MAX_RECTS];
+
+static void assert_rect(const struct display_async_rect *r, uint16_t x, uint16_t y, uint16_t w,
+			uint16_t h)
+{
+	zassert_equal(r->x, x, "x %u", r->x);
+	zassert_equal(r->y, y, "y %u", r->y);
+	zassert_equal(r->w, w, "w %u", r->w);
+	zassert_equal(r->h, h, "h %u", r->h);
+}
+
+static void tile_diff_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(frame, 0, sizeof(frame));
+	zassert_ok(tile_diff_init(&td, RX, RY, RW, RH, PITCH));
+	/* All tiles start dirty: the whole region, merged into one rectangle */
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 1);
+	assert_rect(&rects[0], RX, RY, RW, RH);
+}
+
+ZTEST(tile_diff, test_bad_region)
+{
+	struct tile_diff bad;
+
+	zassert_equal(tile_diff_init(&bad, 0, 0, 0, RH, PITCH), -EINVAL);
+	zassert_equal(tile_diff_init(&bad, PITCH - RW + 1, 0, RW, RH, PITCH), -EINVAL);
+	zassert_equal(tile_diff_init(&bad, 0, 0, 480, 480, 480), -EINVAL);
+}
+
+ZTEST(tile_diff, test_unchanged)
+{
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 0);
+}
+
+ZTEST(tile_diff, test_one_tile)
+{
+	/* Middle tile */
+	frame[(RY + TILE_DIFF_H + 1) * PITCH + RX + TILE_DIFF_W + 3] = sys_cpu_to_be16(0xF800);
+
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 1);
+	assert_rect(&rects[0], RX + TILE_DIFF_W, RY + TILE_DIFF_H, TILE_DIFF_W, TILE_DIFF_H);
+
+	/* Bottom-right (partial) tile */
+	frame[(RY + RH - 1) * PITCH + RX + RW - 1] = sys_cpu_to_be16(0x07E0);
+
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 1);
+	assert_rect(&rects[0], RX + 2 * TILE_DIFF_W, RY + 2 * TILE_DIFF_H, 5, 3);
+}
+
+ZTEST(tile_diff, test_outside_region)
+{
+	frame[(RY + RH) * PITCH + RX] = sys_cpu_to_be16(0xFFFF);
+	frame[RY * PITCH + RX + RW] = sys_cpu_to_be16(0xFFFF);
+
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 0);
+}
+
+ZTEST(tile_diff, test_noise_ignored)
+{
+	frame[RY * PITCH + RX] = sys_cpu_to_be16(~TILE_DIFF_PIXEL_MASK & 0xFFFF);
+
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 0);
+}
+
+ZTEST(tile_diff, test_invalidate)
+{
+	tile_diff_invalidate(&td);
+
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 1);
+	assert_rect(&rects[0], RX, RY, RW, RH);
+	zassert_equal(tile_diff_update(&td, (const uint8_t *)frame, rects, ARRAY_SIZE(rects)), 0);
+}
+
+ZTEST_SUITE(tile_diff, NULL, NULL, tile_diff_before, NULL, NULL);